@@ -0,0 +1,180 @@
+// Compares DistanceTable with the std::unordered_map it replaced in TransportCatalogue: the map
+// kept every distance under both directions, the table keeps it once and falls back to the
+// reverse direction. Both get the same million random distinct stop pairs over 200k stops,
+// then the same lookups, half of them in the reverse direction. Memory is the heap in use
+// right after the build, counted by the global operator new below without the overhead of
+// malloc.
+
+#include "distance_table.h"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <random>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+namespace {
+
+size_t allocated_bytes = 0;
+
+} // namespace
+
+void* operator new(size_t size) {
+    if (void* pointer = std::malloc(size == 0 ? 1 : size)) {
+        allocated_bytes += size;
+        return pointer;
+    }
+    throw std::bad_alloc();
+}
+
+// GCC sees free() on a pointer from operator new once both are inlined, but the operator
+// new above takes the memory from malloc().
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+void operator delete(void* pointer) noexcept {
+    std::free(pointer);
+}
+
+// The containers free their memory through the sized form, which keeps the count exact.
+void operator delete(void* pointer, size_t size) noexcept {
+    allocated_bytes -= size;
+    std::free(pointer);
+}
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+namespace {
+
+using StopPair = std::pair<transport::StopId, transport::StopId>;
+
+constexpr uint32_t STOP_COUNT = 200000;
+constexpr size_t DISTANCE_COUNT = 1000000;
+constexpr size_t LOOKUP_COUNT = 4000000;
+
+// The hasher of the replaced map in TransportCatalogue.
+class NearbyStopsHasher {
+public:
+    size_t operator()(StopPair nearby_stops) const {
+        return std::hash<uint64_t>()((static_cast<uint64_t>(nearby_stops.first) << 32) | nearby_stops.second);
+    }
+};
+
+using DistanceMap = std::unordered_map<StopPair, int, NearbyStopsHasher>;
+
+struct Measurement {
+    double build_seconds = 0.0;
+    double megabytes = 0.0;
+    double lookup_seconds = 0.0;
+    long long checksum = 0;
+};
+
+double GetSeconds(std::chrono::steady_clock::time_point begin, std::chrono::steady_clock::time_point end) {
+    return std::chrono::duration<double>(end - begin).count();
+}
+
+// Distinct unordered pairs of different stops.
+std::vector<StopPair> MakeStopPairs(std::mt19937& generator) {
+    std::uniform_int_distribution<transport::StopId> stop_distribution(0, STOP_COUNT - 1);
+    std::unordered_set<uint64_t> seen_keys;
+    std::vector<StopPair> stop_pairs;
+    stop_pairs.reserve(DISTANCE_COUNT);
+    while (stop_pairs.size() < DISTANCE_COUNT) {
+        transport::StopId stop_from = stop_distribution(generator);
+        transport::StopId stop_to = stop_distribution(generator);
+        if (stop_from == stop_to) {
+            continue;
+        }
+        if (stop_from > stop_to) {
+            std::swap(stop_from, stop_to);
+        }
+        if (seen_keys.insert((static_cast<uint64_t>(stop_from) << 32) | stop_to).second) {
+            stop_pairs.push_back({stop_from, stop_to});
+        }
+    }
+    return stop_pairs;
+}
+
+std::vector<StopPair> MakeLookups(const std::vector<StopPair>& stop_pairs, std::mt19937& generator) {
+    std::uniform_int_distribution<size_t> index_distribution(0, stop_pairs.size() - 1);
+    std::vector<StopPair> lookups;
+    lookups.reserve(LOOKUP_COUNT);
+    for (size_t index = 0; index < LOOKUP_COUNT; ++index) {
+        const auto [stop_from, stop_to] = stop_pairs[index_distribution(generator)];
+        lookups.push_back(index % 2 == 0 ? StopPair{stop_from, stop_to} : StopPair{stop_to, stop_from});
+    }
+    return lookups;
+}
+
+// Built the way TransportCatalogue::AddDistance filled it: the reverse direction is added
+// unless it is already given.
+Measurement MeasureMap(const std::vector<StopPair>& stop_pairs, const std::vector<StopPair>& lookups) {
+    Measurement measurement;
+    const size_t bytes_before = allocated_bytes;
+    const auto build_begin = std::chrono::steady_clock::now();
+    DistanceMap distances;
+    for (size_t index = 0; index < stop_pairs.size(); ++index) {
+        const auto [stop_from, stop_to] = stop_pairs[index];
+        distances[{stop_from, stop_to}] = static_cast<int>(index);
+        distances.emplace(StopPair{stop_to, stop_from}, static_cast<int>(index));
+    }
+    const auto build_end = std::chrono::steady_clock::now();
+    measurement.megabytes = (allocated_bytes - bytes_before) / 1e6;
+    for (const StopPair& lookup : lookups) {
+        measurement.checksum += distances.at(lookup);
+    }
+    measurement.build_seconds = GetSeconds(build_begin, build_end);
+    measurement.lookup_seconds = GetSeconds(build_end, std::chrono::steady_clock::now());
+    return measurement;
+}
+
+Measurement MeasureTable(const std::vector<StopPair>& stop_pairs, const std::vector<StopPair>& lookups) {
+    Measurement measurement;
+    const size_t bytes_before = allocated_bytes;
+    const auto build_begin = std::chrono::steady_clock::now();
+    transport::DistanceTable distances;
+    distances.Reserve(stop_pairs.size());
+    for (size_t index = 0; index < stop_pairs.size(); ++index) {
+        distances.Set(stop_pairs[index].first, stop_pairs[index].second, static_cast<int>(index));
+    }
+    const auto build_end = std::chrono::steady_clock::now();
+    measurement.megabytes = (allocated_bytes - bytes_before) / 1e6;
+    for (const auto& [stop_from, stop_to] : lookups) {
+        measurement.checksum += *distances.Find(stop_from, stop_to);
+    }
+    measurement.build_seconds = GetSeconds(build_begin, build_end);
+    measurement.lookup_seconds = GetSeconds(build_end, std::chrono::steady_clock::now());
+    return measurement;
+}
+
+void PrintMeasurement(const char* name, const Measurement& measurement) {
+    std::cout << name << ": build " << measurement.build_seconds << " s, " << measurement.megabytes << " MB, "
+              << LOOKUP_COUNT << " lookups " << measurement.lookup_seconds << " s" << std::endl;
+}
+
+} // namespace
+
+int main() {
+    std::mt19937 generator(1);
+    const std::vector<StopPair> stop_pairs = MakeStopPairs(generator);
+    const std::vector<StopPair> lookups = MakeLookups(stop_pairs, generator);
+
+    const Measurement map_measurement = MeasureMap(stop_pairs, lookups);
+    PrintMeasurement("unordered_map", map_measurement);
+    const Measurement table_measurement = MeasureTable(stop_pairs, lookups);
+    PrintMeasurement("DistanceTable", table_measurement);
+    if (map_measurement.checksum != table_measurement.checksum) {
+        std::cerr << "The lookups disagree" << std::endl;
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
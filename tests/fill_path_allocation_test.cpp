@@ -0,0 +1,194 @@
+// Checks that TransportRouter::FillPath allocates nothing once the search workspaces of the
+// thread are warmed up: every graph router mode and graph model runs a pass over all stop
+// pairs, then a second pass that must not call operator new. Each pass goes over the pairs
+// twice, by the vertex ids and by the stop names through RequestHandler, the way the JSON
+// Route requests find their paths. The path cache stays off. The total times of both must
+// be the same, and the ones of every mode must match the precomputed ones. Without a wait
+// time the wait/ride graph has zero-weight cycles, which once hung the precomputed router.
+// The array forms of new and delete are left to the defaults, which call the ones below.
+
+#include "map_renderer.h"
+#include "request_handler.h"
+#include "transport_catalogue.h"
+#include "transport_router.h"
+
+#include <atomic>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace {
+
+std::atomic<size_t> allocation_count{0};
+
+} // namespace
+
+void* operator new(size_t size) {
+    ++allocation_count;
+    if (void* pointer = std::malloc(size == 0 ? 1 : size)) {
+        return pointer;
+    }
+    throw std::bad_alloc();
+}
+
+// GCC sees free() on a pointer from operator new once both are inlined, but the operator
+// new above takes the memory from malloc().
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+void operator delete(void* pointer) noexcept {
+    std::free(pointer);
+}
+
+void operator delete(void* pointer, size_t) noexcept {
+    std::free(pointer);
+}
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+namespace {
+
+using namespace std::literals;
+
+constexpr int GRID_SIZE = 6;
+
+std::string GetStopName(int row, int column) {
+    return "Stop "s + std::to_string(row) + "-"s + std::to_string(column);
+}
+
+// A grid of stops with a bus along every row and every column, the column buses go round.
+void FillCatalogue(transport::TransportCatalogue& catalogue) {
+    std::vector<std::string> stop_names;
+    for (int row = 0; row < GRID_SIZE; ++row) {
+        for (int column = 0; column < GRID_SIZE; ++column) {
+            stop_names.push_back(GetStopName(row, column));
+            catalogue.AddStop(stop_names.back(), {55.6 + 0.01 * row, 37.5 + 0.01 * column});
+        }
+    }
+    for (int row = 0; row < GRID_SIZE; ++row) {
+        for (int column = 0; column < GRID_SIZE; ++column) {
+            if (column + 1 < GRID_SIZE) {
+                catalogue.AddDistance(GetStopName(row, column), GetStopName(row, column + 1), 700 + 50 * row);
+            }
+            if (row + 1 < GRID_SIZE) {
+                catalogue.AddDistance(GetStopName(row, column), GetStopName(row + 1, column), 900 + 30 * column);
+            }
+        }
+        catalogue.AddDistance(GetStopName(GRID_SIZE - 1, row), GetStopName(0, row), 2500);
+    }
+    for (int line = 0; line < GRID_SIZE; ++line) {
+        std::vector<std::string_view> row_stops;
+        std::vector<std::string_view> column_stops;
+        for (int index = 0; index < GRID_SIZE; ++index) {
+            row_stops.push_back(stop_names[line * GRID_SIZE + index]);
+            column_stops.push_back(stop_names[index * GRID_SIZE + line]);
+        }
+        column_stops.push_back(column_stops.front());
+        catalogue.AddRoute("R"s + std::to_string(line), row_stops, false);
+        catalogue.AddRoute("C"s + std::to_string(line), column_stops, true);
+    }
+}
+
+// The number of allocations made by the second pass over all stop pairs. The total times
+// of the paths go to total_times, -1 for a path not found, the ones found by the stop names
+// go to request_total_times.
+size_t CountSecondPassAllocations(const transport::TransportCatalogue& catalogue, transport::RouterMode router_mode,
+                                  transport::GraphModel graph_model, int bus_wait_time, std::vector<double>& total_times,
+                                  std::vector<double>& request_total_times) {
+    transport::RoutingSettings settings;
+    settings.bus_velocity = 30.0;
+    settings.bus_wait_time = bus_wait_time;
+    settings.router_mode = router_mode;
+    settings.graph_model = graph_model;
+    transport::TransportRouter router;
+    router.SetSettings(settings);
+    router.UploadTransportData(catalogue);
+
+    const MapRenderer renderer;
+    const RequestHandler handler(catalogue, renderer, router);
+
+    std::vector<std::string_view> stop_names;
+    std::vector<graph::VertexId> vertex_ids;
+    for (const auto& [stop_name, stop] : catalogue.GetAllStops()) {
+        stop_names.push_back(stop_name);
+        vertex_ids.push_back(*router.GetStopVertexId(stop_name));
+    }
+    transport::PathInfo path_info;
+    total_times.assign(vertex_ids.size() * vertex_ids.size(), -1.0);
+    request_total_times.assign(vertex_ids.size() * vertex_ids.size(), -1.0);
+    size_t second_pass_allocation_count = 0;
+    for (int pass = 0; pass < 2; ++pass) {
+        const size_t allocation_count_before = allocation_count;
+        size_t pair_index = 0;
+        for (const graph::VertexId from : vertex_ids) {
+            for (const graph::VertexId to : vertex_ids) {
+                total_times[pair_index++] = router.FillPath(from, to, path_info) ? path_info.total_time : -1.0;
+            }
+        }
+        pair_index = 0;
+        for (const std::string_view from : stop_names) {
+            for (const std::string_view to : stop_names) {
+                request_total_times[pair_index++] = handler.GetPathBetweenTwoStops(from, to, 0.0, path_info)
+                                                    ? path_info.total_time : -1.0;
+            }
+        }
+        second_pass_allocation_count = allocation_count - allocation_count_before;
+    }
+    return second_pass_allocation_count;
+}
+
+} // namespace
+
+int main() {
+    transport::TransportCatalogue catalogue;
+    FillCatalogue(catalogue);
+
+    const std::vector<std::pair<transport::RouterMode, std::string_view>> router_modes = {
+        {transport::RouterMode::PRECOMPUTED, "precomputed"sv},
+        {transport::RouterMode::ON_DEMAND, "on_demand"sv},
+        {transport::RouterMode::CONTRACTION_HIERARCHY, "contraction_hierarchy"sv},
+        {transport::RouterMode::LANDMARKS, "landmarks"sv},
+    };
+    const std::vector<std::pair<transport::GraphModel, std::string_view>> graph_models = {
+        {transport::GraphModel::STOP_TO_STOP, "stop_to_stop"sv},
+        {transport::GraphModel::WAIT_RIDE, "wait_ride"sv},
+    };
+    const size_t pair_count = GRID_SIZE * GRID_SIZE * GRID_SIZE * GRID_SIZE;
+    bool is_failed = false;
+    for (const int bus_wait_time : {4, 0}) {
+        for (const auto& [graph_model, graph_model_name] : graph_models) {
+            std::vector<double> precomputed_total_times;
+            for (const auto& [router_mode, router_mode_name] : router_modes) {
+                std::vector<double> total_times;
+                std::vector<double> request_total_times;
+                const size_t allocations = CountSecondPassAllocations(catalogue, router_mode, graph_model, bus_wait_time,
+                                                                      total_times, request_total_times);
+                if (precomputed_total_times.empty()) {
+                    precomputed_total_times = total_times;
+                }
+                size_t found_count = 0;
+                size_t mismatch_count = 0;
+                for (size_t pair_index = 0; pair_index < total_times.size(); ++pair_index) {
+                    found_count += total_times[pair_index] >= 0.0 ? 1 : 0;
+                    mismatch_count += std::abs(total_times[pair_index] - precomputed_total_times[pair_index]) > 1e-9
+                                      || request_total_times[pair_index] != total_times[pair_index] ? 1 : 0;
+                }
+                const bool is_passed = allocations == 0 && found_count == pair_count && mismatch_count == 0;
+                is_failed = is_failed || !is_passed;
+                std::cout << (is_passed ? "OK   "sv : "FAIL "sv) << router_mode_name << " / "sv << graph_model_name
+                          << " / wait "sv << bus_wait_time << ": "sv << allocations << " allocations, "sv << found_count
+                          << " of "sv << pair_count << " paths found, "sv << mismatch_count << " times differ"sv
+                          << std::endl;
+            }
+        }
+    }
+    return is_failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
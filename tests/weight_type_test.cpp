@@ -0,0 +1,152 @@
+// Compares the routers with float and int32_t weights with the double one on a random
+// network: for every pair of stops both must find a path exactly when the double router
+// does, with a total time within the tolerance of its weight type. Every graph model runs
+// with the precomputed and the on-demand router. The total times are also counted by
+// whether they print the same as the double ones with the 6 significant digits of the JSON
+// output.
+
+#include "transport_catalogue.h"
+#include "transport_router.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <random>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace {
+
+using namespace std::literals;
+
+constexpr int STOP_COUNT = 120;
+constexpr int ROUTE_COUNT = 25;
+
+// A float keeps 24 bits of the time in minutes, every addition along a path may lose half
+// a unit of the last place, about 6e-8 of the sum. A fixed point weight is off by at most
+// half a unit, 1 / 1200000 of a minute, per edge, the bound allows 60 edges.
+constexpr double FLOAT_RELATIVE_TOLERANCE = 1e-6;
+constexpr double INT32_ABSOLUTE_TOLERANCE = 5e-5;
+
+std::string GetStopName(int index) {
+    return "Stop "s + std::to_string(index);
+}
+
+void FillCatalogue(transport::TransportCatalogue& catalogue) {
+    std::mt19937 generator(17);
+    std::uniform_real_distribution<double> latitude_distribution(55.55, 55.95);
+    std::uniform_real_distribution<double> longitude_distribution(37.35, 37.85);
+    std::uniform_int_distribution<int> stop_distribution(0, STOP_COUNT - 1);
+    std::uniform_int_distribution<int> length_distribution(6, 14);
+    std::uniform_int_distribution<int> distance_distribution(200, 5000);
+
+    std::vector<std::string> stop_names;
+    for (int index = 0; index < STOP_COUNT; ++index) {
+        stop_names.push_back(GetStopName(index));
+        catalogue.AddStop(stop_names.back(), {latitude_distribution(generator), longitude_distribution(generator)});
+    }
+    for (int route = 0; route < ROUTE_COUNT; ++route) {
+        const bool is_roundtrip = route % 3 == 0;
+        std::vector<std::string_view> route_stops;
+        const int length = length_distribution(generator);
+        while (static_cast<int>(route_stops.size()) < length) {
+            const std::string_view stop_name = stop_names[stop_distribution(generator)];
+            if (std::find(route_stops.begin(), route_stops.end(), stop_name) == route_stops.end()) {
+                route_stops.push_back(stop_name);
+            }
+        }
+        if (is_roundtrip) {
+            route_stops.push_back(route_stops.front());
+        }
+        for (size_t index = 0; index + 1 < route_stops.size(); ++index) {
+            catalogue.AddDistance(route_stops[index], route_stops[index + 1], distance_distribution(generator));
+        }
+        catalogue.AddRoute("Bus "s + std::to_string(route), route_stops, is_roundtrip);
+    }
+}
+
+// The total times of the paths between all pairs of stops, nullopt for a path not found.
+std::vector<std::optional<double>> ComputeTotalTimes(const transport::TransportCatalogue& catalogue,
+                                                     const transport::RoutingSettings& settings) {
+    const auto router = transport::MakeTransportRouter(settings);
+    router->UploadTransportData(catalogue);
+    std::vector<std::optional<double>> total_times;
+    for (int from = 0; from < STOP_COUNT; ++from) {
+        for (int to = 0; to < STOP_COUNT; ++to) {
+            const auto path_info = router->BuildPath(GetStopName(from), GetStopName(to));
+            total_times.push_back(path_info ? std::optional<double>(path_info->total_time) : std::nullopt);
+        }
+    }
+    return total_times;
+}
+
+std::string PrintLikeJson(double value) {
+    std::ostringstream output;
+    output << value;
+    return output.str();
+}
+
+} // namespace
+
+int main() {
+    transport::TransportCatalogue catalogue;
+    FillCatalogue(catalogue);
+
+    const std::vector<std::pair<transport::RouterMode, std::string_view>> router_modes = {
+        {transport::RouterMode::PRECOMPUTED, "precomputed"sv},
+        {transport::RouterMode::ON_DEMAND, "on_demand"sv},
+    };
+    const std::vector<std::pair<transport::GraphModel, std::string_view>> graph_models = {
+        {transport::GraphModel::STOP_TO_STOP, "stop_to_stop"sv},
+        {transport::GraphModel::WAIT_RIDE, "wait_ride"sv},
+    };
+    const std::vector<std::pair<transport::WeightType, std::string_view>> weight_types = {
+        {transport::WeightType::FLOAT, "float"sv},
+        {transport::WeightType::INT32, "int32"sv},
+    };
+    bool is_failed = false;
+    for (const auto& [router_mode, router_mode_name] : router_modes) {
+        for (const auto& [graph_model, graph_model_name] : graph_models) {
+            transport::RoutingSettings settings;
+            settings.bus_velocity = 37.0;
+            settings.bus_wait_time = 5;
+            settings.router_mode = router_mode;
+            settings.graph_model = graph_model;
+            const std::vector<std::optional<double>> double_total_times = ComputeTotalTimes(catalogue, settings);
+            for (const auto& [weight_type, weight_type_name] : weight_types) {
+                settings.weight_type = weight_type;
+                const std::vector<std::optional<double>> total_times = ComputeTotalTimes(catalogue, settings);
+                size_t bad_count = 0;
+                size_t printed_differently_count = 0;
+                double max_difference = 0.0;
+                for (size_t index = 0; index < total_times.size(); ++index) {
+                    if (total_times[index].has_value() != double_total_times[index].has_value()) {
+                        ++bad_count;
+                        continue;
+                    }
+                    if (!total_times[index]) {
+                        continue;
+                    }
+                    const double expected = *double_total_times[index];
+                    const double difference = std::abs(*total_times[index] - expected);
+                    const double tolerance = weight_type == transport::WeightType::FLOAT
+                                             ? FLOAT_RELATIVE_TOLERANCE * expected : INT32_ABSOLUTE_TOLERANCE;
+                    bad_count += difference > tolerance ? 1 : 0;
+                    printed_differently_count += PrintLikeJson(*total_times[index]) != PrintLikeJson(expected) ? 1 : 0;
+                    max_difference = std::max(max_difference, difference);
+                }
+                is_failed = is_failed || bad_count > 0;
+                std::cout << (bad_count == 0 ? "OK   "sv : "FAIL "sv) << router_mode_name << " / "sv << graph_model_name
+                          << " / "sv << weight_type_name << ": "sv << bad_count << " out of tolerance, max difference "sv
+                          << max_difference << " min, "sv << printed_differently_count << " of "sv << total_times.size()
+                          << " printed differently"sv << std::endl;
+            }
+        }
+    }
+    return is_failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
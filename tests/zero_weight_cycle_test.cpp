@@ -0,0 +1,131 @@
+// Regression test for graphs with zero-weight cycles, like the wait/ride graph without a wait
+// time: the precomputed router once left a cycle of last edges in its table, and building
+// a route along it never ended. The routes of Router must be chains of edges from the source
+// to the target with the weights found by DijkstraRouter, both after the build and after
+// updates that replace lines of the graph. The graph has more vertices than a tile of the
+// blocked Floyd-Warshall.
+
+#include "dijkstra_router.h"
+#include "graph.h"
+#include "router.h"
+
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace {
+
+using namespace std::literals;
+
+using Graph = graph::DirectedWeightedGraph<double>;
+
+constexpr size_t STOP_COUNT = 60;
+constexpr size_t LINE_COUNT = 12;
+constexpr size_t LINE_LENGTH = 9;
+constexpr size_t UPDATE_COUNT = 4;
+
+// A line of ride vertices over random stops, its edges are returned. Boarding and alighting
+// edges weigh nothing, so every stop lies on zero-weight cycles through the ride vertices
+// of the lines calling at it.
+std::vector<graph::EdgeId> AddLine(Graph& graph, std::mt19937& generator) {
+    std::uniform_int_distribution<graph::VertexId> stop_distribution(0, STOP_COUNT - 1);
+    std::uniform_int_distribution<int> ride_time_distribution(0, 5);
+    std::vector<graph::EdgeId> edges;
+    std::optional<graph::VertexId> prev_ride_vertex;
+    for (size_t index = 0; index < LINE_LENGTH; ++index) {
+        const graph::VertexId stop = stop_distribution(generator);
+        const graph::VertexId ride_vertex = graph.AddVertex();
+        edges.push_back(graph.AddEdge({stop, ride_vertex, 0.0}));
+        edges.push_back(graph.AddEdge({ride_vertex, stop, 0.0}));
+        if (prev_ride_vertex) {
+            const double ride_time = ride_time_distribution(generator);
+            edges.push_back(graph.AddEdge({*prev_ride_vertex, ride_vertex, ride_time}));
+        }
+        prev_ride_vertex = ride_vertex;
+    }
+    return edges;
+}
+
+// The number of (from, to) pairs whose route is missing, extra, not a chain from `from`
+// to `to` or not of the reference weight.
+size_t CountBadRoutes(const Graph& graph, const graph::Router<double>& router) {
+    const graph::DijkstraRouter<double> reference_router(graph);
+    size_t bad_count = 0;
+    for (graph::VertexId from = 0; from < graph.GetVertexCount(); ++from) {
+        for (graph::VertexId to = 0; to < graph.GetVertexCount(); ++to) {
+            std::optional<graph::RouterBase<double>::RouteInfo> route;
+            try {
+                route = router.BuildRoute(from, to);
+            } catch (const std::logic_error&) {
+                ++bad_count;
+                continue;
+            }
+            const auto reference_route = reference_router.BuildRoute(from, to);
+            if (route.has_value() != reference_route.has_value()) {
+                ++bad_count;
+                continue;
+            }
+            if (!route) {
+                continue;
+            }
+            graph::VertexId vertex = from;
+            double weight = 0.0;
+            for (const graph::EdgeId edge_id : route->edges) {
+                const auto& edge = graph.GetEdge(edge_id);
+                if (edge.from != vertex) {
+                    break;
+                }
+                vertex = edge.to;
+                weight += edge.weight;
+            }
+            if (vertex != to || weight != route->weight || route->weight != reference_route->weight) {
+                ++bad_count;
+            }
+        }
+    }
+    return bad_count;
+}
+
+} // namespace
+
+int main() {
+    bool is_failed = false;
+    const auto check = [&is_failed](const Graph& graph, const graph::Router<double>& router, unsigned seed,
+                                    size_t update) {
+        const size_t bad_count = CountBadRoutes(graph, router);
+        is_failed = is_failed || bad_count > 0;
+        std::cout << (bad_count == 0 ? "OK   "sv : "FAIL "sv) << "seed "sv << seed << ", update "sv << update << ": "sv
+                  << bad_count << " bad routes of "sv << graph.GetVertexCount() * graph.GetVertexCount() << std::endl;
+    };
+    for (unsigned seed = 1; seed <= 5; ++seed) {
+        std::mt19937 generator(seed);
+        Graph graph(STOP_COUNT);
+        std::vector<std::vector<graph::EdgeId>> lines;
+        for (size_t line = 0; line < LINE_COUNT; ++line) {
+            lines.push_back(AddLine(graph, generator));
+        }
+        auto router = std::make_unique<graph::Router<double>>(graph);
+        check(graph, *router, seed, 0);
+
+        // Every update replaces a line by a new one, the way TransportRouter::UpdateRoutes does.
+        for (size_t update = 1; update <= UPDATE_COUNT; ++update) {
+            std::vector<graph::EdgeId>& line = lines[generator() % lines.size()];
+            for (const graph::EdgeId edge_id : line) {
+                graph.RemoveEdge(edge_id);
+            }
+            const std::vector<graph::EdgeId> removed_edges = std::move(line);
+            line = AddLine(graph, generator);
+            if (!router->UpdateEdges(removed_edges, line)) {
+                router = std::make_unique<graph::Router<double>>(graph);
+            }
+            check(graph, *router, seed, update);
+        }
+    }
+    return is_failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
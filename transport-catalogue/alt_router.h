@@ -0,0 +1,247 @@
+#pragma once
+
+#include "geo.h"
+#include "router.h"
+#include "search_workspace.h"
+#include "static_graph.h"
+
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <optional>
+#include <queue>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace graph {
+
+// A* search with ALT (landmarks and triangle inequality) lower bounds. For a landmark L
+// the weight of any route v -> t is at least d(L, t) - d(L, v) and d(v, L) - d(t, L).
+// If vertex coordinates are given, the bound is also at least GEO_FACTOR * distance(v, t),
+// where GEO_FACTOR is the smallest edge weight per meter of great-circle distance over
+// the graph, so the bound stays admissible for any input.
+template <typename Weight>
+class AltRouter : public RouterBase<Weight> {
+private:
+    using Graph = DirectedWeightedGraph<Weight>;
+
+public:
+    using RouteInfo = typename RouterBase<Weight>::RouteInfo;
+
+    AltRouter(const Graph& graph, size_t landmark_count, std::vector<geo::Coordinates> vertex_coordinates = {});
+
+    bool FillRoute(VertexId from, VertexId to, RouteInfo& route_info) const override;
+
+private:
+    using Workspace = SearchWorkspace<Weight>;
+    using QueueItem = std::pair<Weight, VertexId>;
+    using Queue = std::priority_queue<QueueItem, std::vector<QueueItem>, std::greater<QueueItem>>;
+
+    void SelectLandmarks(size_t landmark_count);
+    void CalculateGeoFactor();
+    std::vector<Weight> CalculateWeightsFrom(VertexId source, const StaticGraph<Weight>& graph) const;
+    Weight CalculateLowerBound(VertexId vertex, VertexId to) const;
+
+    static constexpr Weight ZERO_WEIGHT{};
+    static constexpr Weight UNREACHABLE_WEIGHT = std::numeric_limits<Weight>::has_infinity
+                                                 ? std::numeric_limits<Weight>::infinity()
+                                                 : std::numeric_limits<Weight>::max();
+    const Graph& graph_;
+    StaticGraph<Weight> static_graph_;
+    StaticGraph<Weight> reversed_graph_;
+    std::vector<geo::Coordinates> vertex_coordinates_;
+    std::optional<double> geo_factor_;
+
+    // V x landmark_count tables in vertex-major order, so the bound for a vertex reads
+    // one contiguous block: weights from every landmark and to every landmark.
+    std::vector<VertexId> landmarks_;
+    std::vector<Weight> weights_from_landmarks_;
+    std::vector<Weight> weights_to_landmarks_;
+};
+
+template <typename Weight>
+AltRouter<Weight>::AltRouter(const Graph& graph, size_t landmark_count, std::vector<geo::Coordinates> vertex_coordinates)
+    : graph_(graph)
+    , static_graph_(graph)
+    , vertex_coordinates_(std::move(vertex_coordinates))
+{
+    std::vector<std::pair<VertexId, typename StaticGraph<Weight>::IncidentEdge>> reversed_edges;
+    reversed_edges.reserve(static_graph_.GetEdgeCount());
+    for (VertexId vertex = 0; vertex < static_graph_.GetVertexCount(); ++vertex) {
+        for (const auto& edge : static_graph_.GetIncidentEdges(vertex)) {
+            if (edge.weight < ZERO_WEIGHT) {
+                throw std::domain_error("Edges' weights should be non-negative");
+            }
+            reversed_edges.push_back({edge.to, {vertex, edge.weight, edge.edge_id}});
+        }
+    }
+    reversed_graph_ = StaticGraph<Weight>(graph.GetVertexCount(), reversed_edges);
+
+    if (!vertex_coordinates_.empty()) {
+        if (vertex_coordinates_.size() != graph.GetVertexCount()) {
+            throw std::invalid_argument("Coordinates should be given for every vertex");
+        }
+        CalculateGeoFactor();
+    }
+    SelectLandmarks(std::min(landmark_count, graph.GetVertexCount()));
+}
+
+// The potential of a vertex is its lower bound, computed once per search when the vertex
+// is first reached.
+template <typename Weight>
+bool AltRouter<Weight>::FillRoute(VertexId from, VertexId to, RouteInfo& route_info) const {
+    const size_t vertex_count = static_graph_.GetVertexCount();
+    if (from >= vertex_count || to >= vertex_count) {
+        throw std::out_of_range("Vertex id is out of range");
+    }
+    auto& workspace = Workspace::Acquire(vertex_count);
+    workspace.SetPotential(from, CalculateLowerBound(from, to));
+    workspace.Reach(from, ZERO_WEIGHT, Workspace::NO_EDGE);
+    workspace.PushQueue(workspace.GetPotential(from), from);
+
+    while (!workspace.IsQueueEmpty()) {
+        const VertexId vertex = workspace.PopQueue().second;
+        if (workspace.IsSettled(vertex)) {
+            continue;
+        }
+        workspace.Settle(vertex);
+        if (vertex == to) {
+            break;
+        }
+        const Weight weight = workspace.GetWeight(vertex);
+        for (const auto& edge : static_graph_.GetIncidentEdges(vertex)) {
+            const Weight candidate_weight = weight + edge.weight;
+            if (workspace.IsSettled(edge.to)) {
+                continue;
+            }
+            if (!workspace.IsReached(edge.to)) {
+                workspace.SetPotential(edge.to, CalculateLowerBound(edge.to, to));
+            } else if (!(candidate_weight < workspace.GetWeight(edge.to))) {
+                continue;
+            }
+            workspace.Reach(edge.to, candidate_weight, edge.edge_id);
+            workspace.PushQueue(candidate_weight + workspace.GetPotential(edge.to), edge.to);
+        }
+    }
+
+    if (!workspace.IsReached(to)) {
+        return false;
+    }
+    auto& edges = route_info.edges;
+    edges.clear();
+    for (EdgeId edge_id = workspace.GetPrevEdge(to);
+         edge_id != Workspace::NO_EDGE;
+         edge_id = workspace.GetPrevEdge(graph_.GetEdge(edge_id).from))
+    {
+        edges.push_back(edge_id);
+    }
+    std::reverse(edges.begin(), edges.end());
+    route_info.weight = workspace.GetWeight(to);
+    return true;
+}
+
+// Farthest selection: every next landmark is the vertex farthest from the chosen ones,
+// a vertex unreachable from all of them goes first.
+template <typename Weight>
+void AltRouter<Weight>::SelectLandmarks(size_t landmark_count) {
+    const size_t vertex_count = static_graph_.GetVertexCount();
+    std::vector<std::vector<Weight>> weights_from_landmarks;
+    std::vector<std::vector<Weight>> weights_to_landmarks;
+    std::vector<Weight> weights_from_chosen(vertex_count, UNREACHABLE_WEIGHT);
+    VertexId next_landmark = 0;
+    for (size_t landmark_index = 0; landmark_index < landmark_count; ++landmark_index) {
+        landmarks_.push_back(next_landmark);
+        weights_from_landmarks.push_back(CalculateWeightsFrom(next_landmark, static_graph_));
+        weights_to_landmarks.push_back(CalculateWeightsFrom(next_landmark, reversed_graph_));
+
+        const auto& weights_from_landmark = weights_from_landmarks.back();
+        std::optional<VertexId> farthest_vertex;
+        for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
+            weights_from_chosen[vertex] = std::min(weights_from_chosen[vertex], weights_from_landmark[vertex]);
+            const bool is_chosen = std::find(landmarks_.begin(), landmarks_.end(), vertex) != landmarks_.end();
+            if (!is_chosen && (!farthest_vertex || weights_from_chosen[vertex] > weights_from_chosen[*farthest_vertex])) {
+                farthest_vertex = vertex;
+            }
+        }
+        if (!farthest_vertex) {
+            break;
+        }
+        next_landmark = *farthest_vertex;
+    }
+
+    const size_t chosen_count = landmarks_.size();
+    weights_from_landmarks_.resize(vertex_count * chosen_count);
+    weights_to_landmarks_.resize(vertex_count * chosen_count);
+    for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
+        for (size_t landmark_index = 0; landmark_index < chosen_count; ++landmark_index) {
+            weights_from_landmarks_[vertex * chosen_count + landmark_index] = weights_from_landmarks[landmark_index][vertex];
+            weights_to_landmarks_[vertex * chosen_count + landmark_index] = weights_to_landmarks[landmark_index][vertex];
+        }
+    }
+}
+
+template <typename Weight>
+void AltRouter<Weight>::CalculateGeoFactor() {
+    for (VertexId vertex = 0; vertex < static_graph_.GetVertexCount(); ++vertex) {
+        for (const auto& edge : static_graph_.GetIncidentEdges(vertex)) {
+            const double distance = geo::ComputeDistance(vertex_coordinates_[vertex], vertex_coordinates_[edge.to]);
+            if (distance > 0.0) {
+                const double factor = static_cast<double>(edge.weight) / distance;
+                geo_factor_ = geo_factor_ ? std::min(*geo_factor_, factor) : factor;
+            }
+        }
+    }
+}
+
+template <typename Weight>
+std::vector<Weight> AltRouter<Weight>::CalculateWeightsFrom(VertexId source, const StaticGraph<Weight>& graph) const {
+    std::vector<Weight> weights(graph.GetVertexCount(), UNREACHABLE_WEIGHT);
+    std::vector<bool> is_settled(graph.GetVertexCount(), false);
+    Queue queue;
+    weights[source] = ZERO_WEIGHT;
+    queue.push({ZERO_WEIGHT, source});
+    while (!queue.empty()) {
+        const auto [weight, vertex] = queue.top();
+        queue.pop();
+        if (is_settled[vertex]) {
+            continue;
+        }
+        is_settled[vertex] = true;
+        for (const auto& edge : graph.GetIncidentEdges(vertex)) {
+            const Weight candidate_weight = weight + edge.weight;
+            if (!is_settled[edge.to] && (weights[edge.to] == UNREACHABLE_WEIGHT || candidate_weight < weights[edge.to])) {
+                weights[edge.to] = candidate_weight;
+                queue.push({candidate_weight, edge.to});
+            }
+        }
+    }
+    return weights;
+}
+
+template <typename Weight>
+Weight AltRouter<Weight>::CalculateLowerBound(VertexId vertex, VertexId to) const {
+    Weight lower_bound = ZERO_WEIGHT;
+    const size_t landmark_count = landmarks_.size();
+    const Weight* const from_landmarks_to_vertex = weights_from_landmarks_.data() + vertex * landmark_count;
+    const Weight* const from_landmarks_to_target = weights_from_landmarks_.data() + to * landmark_count;
+    const Weight* const to_landmarks_from_vertex = weights_to_landmarks_.data() + vertex * landmark_count;
+    const Weight* const to_landmarks_from_target = weights_to_landmarks_.data() + to * landmark_count;
+    for (size_t landmark_index = 0; landmark_index < landmark_count; ++landmark_index) {
+        if (from_landmarks_to_vertex[landmark_index] != UNREACHABLE_WEIGHT && from_landmarks_to_target[landmark_index] != UNREACHABLE_WEIGHT
+            && from_landmarks_to_target[landmark_index] > from_landmarks_to_vertex[landmark_index]) {
+            lower_bound = std::max(lower_bound, from_landmarks_to_target[landmark_index] - from_landmarks_to_vertex[landmark_index]);
+        }
+        if (to_landmarks_from_vertex[landmark_index] != UNREACHABLE_WEIGHT && to_landmarks_from_target[landmark_index] != UNREACHABLE_WEIGHT
+            && to_landmarks_from_vertex[landmark_index] > to_landmarks_from_target[landmark_index]) {
+            lower_bound = std::max(lower_bound, to_landmarks_from_vertex[landmark_index] - to_landmarks_from_target[landmark_index]);
+        }
+    }
+    if (geo_factor_) {
+        const double distance = geo::ComputeDistance(vertex_coordinates_[vertex], vertex_coordinates_[to]);
+        lower_bound = std::max(lower_bound, static_cast<Weight>(*geo_factor_ * distance));
+    }
+    return lower_bound;
+}
+
+}  // namespace graph
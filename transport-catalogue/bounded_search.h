@@ -0,0 +1,77 @@
+#pragma once
+
+#include "graph.h"
+#include "search_workspace.h"
+#include "static_graph.h"
+
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace graph {
+
+// One-to-all Dijkstra that stops at a weight budget: only the vertices within the budget
+// are settled. The search runs in the SearchWorkspace of the calling thread.
+template <typename Weight>
+class BoundedSearch {
+public:
+    // The graph must outlive the search.
+    explicit BoundedSearch(const StaticGraph<Weight>& graph);
+
+    // Pairs of the vertices with weight(from -> vertex) <= max_weight and the weights,
+    // in the order of the weights.
+    std::vector<std::pair<VertexId, Weight>> FindReachable(VertexId from, Weight max_weight) const;
+
+private:
+    using Workspace = SearchWorkspace<Weight>;
+
+    static constexpr Weight ZERO_WEIGHT{};
+    const StaticGraph<Weight>& graph_;
+};
+
+template <typename Weight>
+BoundedSearch<Weight>::BoundedSearch(const StaticGraph<Weight>& graph)
+    : graph_(graph)
+{
+    for (VertexId vertex = 0; vertex < graph_.GetVertexCount(); ++vertex) {
+        for (const auto& edge : graph_.GetIncidentEdges(vertex)) {
+            if (edge.weight < ZERO_WEIGHT) {
+                throw std::domain_error("Edges' weights should be non-negative");
+            }
+        }
+    }
+}
+
+template <typename Weight>
+std::vector<std::pair<VertexId, Weight>> BoundedSearch<Weight>::FindReachable(VertexId from, Weight max_weight) const {
+    const size_t vertex_count = graph_.GetVertexCount();
+    if (from >= vertex_count) {
+        throw std::out_of_range("Vertex id is out of range");
+    }
+    auto& workspace = Workspace::Acquire(vertex_count);
+    workspace.Reach(from, ZERO_WEIGHT, Workspace::NO_EDGE);
+    workspace.PushQueue(ZERO_WEIGHT, from);
+
+    std::vector<std::pair<VertexId, Weight>> reachable;
+    while (!workspace.IsQueueEmpty()) {
+        const auto [weight, vertex] = workspace.PopQueue();
+        if (workspace.IsSettled(vertex)) {
+            continue;
+        }
+        workspace.Settle(vertex);
+        reachable.push_back({vertex, weight});
+        for (const auto& edge : graph_.GetIncidentEdges(vertex)) {
+            const Weight candidate_weight = weight + edge.weight;
+            if (candidate_weight > max_weight || workspace.IsSettled(edge.to)) {
+                continue;
+            }
+            if (!workspace.IsReached(edge.to) || candidate_weight < workspace.GetWeight(edge.to)) {
+                workspace.Reach(edge.to, candidate_weight, edge.edge_id);
+                workspace.PushQueue(candidate_weight, edge.to);
+            }
+        }
+    }
+    return reachable;
+}
+
+}  // namespace graph
@@ -0,0 +1,546 @@
+#pragma once
+
+#include "router.h"
+#include "search_workspace.h"
+#include "static_graph.h"
+
+#include <algorithm>
+#include <functional>
+#include <optional>
+#include <queue>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace graph {
+
+template <typename Weight>
+class ContractionHierarchyRouter : public RouterBase<Weight> {
+private:
+    using Graph = DirectedWeightedGraph<Weight>;
+
+public:
+    using RouteInfo = typename RouterBase<Weight>::RouteInfo;
+    using WeightMatrix = typename RouterBase<Weight>::WeightMatrix;
+
+    explicit ContractionHierarchyRouter(const Graph& graph);
+
+    bool FillRoute(VertexId from, VertexId to, RouteInfo& route_info) const override;
+    WeightMatrix BuildWeightMatrix(const std::vector<VertexId>& sources, const std::vector<VertexId>& targets,
+                                   concurrency::ThreadPool& thread_pool) const override;
+
+private:
+    // The first graph.GetEdgeCount() entries mirror the original edges, so an original
+    // edge keeps its EdgeId; shortcuts are appended after them and remember the pair of
+    // edges they replace.
+    struct HierarchyEdge {
+        VertexId from;
+        VertexId to;
+        Weight weight;
+        std::optional<std::pair<EdgeId, EdgeId>> shortcut_edges;
+    };
+
+    using Workspace = SearchWorkspace<Weight>;
+    using QueueItem = std::pair<Weight, VertexId>;
+    using Queue = std::priority_queue<QueueItem, std::vector<QueueItem>, std::greater<QueueItem>>;
+
+    static constexpr size_t WITNESS_SEARCH_SETTLE_LIMIT = 100;
+
+    void InitializeHierarchyEdges(const Graph& graph);
+    void ContractVertices();
+    void BuildUpwardGraphs(size_t vertex_count);
+    int ContractVertex(VertexId vertex, bool is_simulation);
+    int CalculateVertexPriority(VertexId vertex);
+    void RunWitnessSearch(VertexId source, VertexId vertex_excluded, const std::vector<EdgeId>& edges_to_targets, Weight max_weight);
+    void AddOrImproveEdge(VertexId from, VertexId to, Weight weight, std::optional<std::pair<EdgeId, EdgeId>> shortcut_edges);
+    void UnpackEdge(EdgeId edge_id, std::vector<EdgeId>& original_edges, std::vector<EdgeId>& edges_stack) const;
+    std::vector<std::pair<VertexId, Weight>> RunUpwardSearch(VertexId start, const StaticGraph<Weight>& upward_graph) const;
+
+    static void EraseEdgeTo(std::vector<EdgeId>& edge_ids, const std::vector<HierarchyEdge>& edges, VertexId vertex);
+    static void EraseEdgeFrom(std::vector<EdgeId>& edge_ids, const std::vector<HierarchyEdge>& edges, VertexId vertex);
+
+    static constexpr Weight ZERO_WEIGHT{};
+    std::vector<HierarchyEdge> edges_;
+
+    // Preprocessing state: the overlay graph of the vertices that are not contracted yet.
+    std::vector<std::vector<EdgeId>> overlay_outgoing_edges_;
+    std::vector<std::vector<EdgeId>> overlay_incoming_edges_;
+    std::vector<bool> is_contracted_;
+    std::vector<int> contracted_neighbors_count_;
+    std::vector<std::optional<Weight>> witness_weights_;
+    std::vector<VertexId> witness_touched_vertices_;
+    std::vector<bool> is_witness_target_;
+
+    // Edges leading to higher ranked vertices, collected during the contraction and then
+    // packed into the query graphs: the forward one and the reversed one for the backward search.
+    std::vector<std::vector<EdgeId>> upward_outgoing_edges_;
+    std::vector<std::vector<EdgeId>> upward_incoming_edges_;
+    StaticGraph<Weight> forward_upward_graph_;
+    StaticGraph<Weight> backward_upward_graph_;
+};
+
+template <typename Weight>
+ContractionHierarchyRouter<Weight>::ContractionHierarchyRouter(const Graph& graph)
+    : overlay_outgoing_edges_(graph.GetVertexCount())
+    , overlay_incoming_edges_(graph.GetVertexCount())
+    , is_contracted_(graph.GetVertexCount(), false)
+    , contracted_neighbors_count_(graph.GetVertexCount(), 0)
+    , witness_weights_(graph.GetVertexCount())
+    , is_witness_target_(graph.GetVertexCount(), false)
+    , upward_outgoing_edges_(graph.GetVertexCount())
+    , upward_incoming_edges_(graph.GetVertexCount())
+{
+    InitializeHierarchyEdges(graph);
+    ContractVertices();
+    BuildUpwardGraphs(graph.GetVertexCount());
+
+    overlay_outgoing_edges_ = {};
+    overlay_incoming_edges_ = {};
+    is_contracted_ = {};
+    contracted_neighbors_count_ = {};
+    witness_weights_ = {};
+    witness_touched_vertices_ = {};
+    is_witness_target_ = {};
+    upward_outgoing_edges_ = {};
+    upward_incoming_edges_ = {};
+}
+
+// The forward and the backward searches take their own workspaces. The hierarchy edges
+// of the route are collected in the path buffer of the first one and unpacked with the
+// path buffer of the second one as the stack.
+template <typename Weight>
+bool ContractionHierarchyRouter<Weight>::FillRoute(VertexId from, VertexId to, RouteInfo& route_info) const {
+    const size_t vertex_count = forward_upward_graph_.GetVertexCount();
+    if (from >= vertex_count || to >= vertex_count) {
+        throw std::out_of_range("Vertex id is out of range");
+    }
+    if (from == to) {
+        route_info.weight = ZERO_WEIGHT;
+        route_info.edges.clear();
+        return true;
+    }
+
+    auto& forward_workspace = Workspace::Acquire(vertex_count, 0);
+    auto& backward_workspace = Workspace::Acquire(vertex_count, 1);
+    forward_workspace.Reach(from, ZERO_WEIGHT, Workspace::NO_EDGE);
+    backward_workspace.Reach(to, ZERO_WEIGHT, Workspace::NO_EDGE);
+    forward_workspace.PushQueue(ZERO_WEIGHT, from);
+    backward_workspace.PushQueue(ZERO_WEIGHT, to);
+
+    std::optional<Weight> best_weight;
+    std::optional<VertexId> meeting_vertex;
+
+    auto step = [&](Workspace& own_workspace, const Workspace& other_workspace, const StaticGraph<Weight>& upward_graph) {
+        const auto [weight, vertex] = own_workspace.PopQueue();
+        if (weight > own_workspace.GetWeight(vertex)) {
+            return;
+        }
+        if (other_workspace.IsReached(vertex)) {
+            const Weight candidate_weight = weight + other_workspace.GetWeight(vertex);
+            if (!best_weight || candidate_weight < *best_weight) {
+                best_weight = candidate_weight;
+                meeting_vertex = vertex;
+            }
+        }
+        for (const auto& edge : upward_graph.GetIncidentEdges(vertex)) {
+            const Weight candidate_weight = weight + edge.weight;
+            if (!own_workspace.IsReached(edge.to) || candidate_weight < own_workspace.GetWeight(edge.to)) {
+                own_workspace.Reach(edge.to, candidate_weight, edge.edge_id);
+                own_workspace.PushQueue(candidate_weight, edge.to);
+            }
+        }
+    };
+
+    while (true) {
+        const bool forward_is_active = !forward_workspace.IsQueueEmpty()
+                                       && (!best_weight || forward_workspace.GetQueueTop().first < *best_weight);
+        const bool backward_is_active = !backward_workspace.IsQueueEmpty()
+                                        && (!best_weight || backward_workspace.GetQueueTop().first < *best_weight);
+        if (!forward_is_active && !backward_is_active) {
+            break;
+        }
+        if (forward_is_active
+            && (!backward_is_active || forward_workspace.GetQueueTop().first <= backward_workspace.GetQueueTop().first)) {
+            step(forward_workspace, backward_workspace, forward_upward_graph_);
+        } else {
+            step(backward_workspace, forward_workspace, backward_upward_graph_);
+        }
+    }
+
+    if (!meeting_vertex) {
+        return false;
+    }
+
+    std::vector<EdgeId>& hierarchy_edges = forward_workspace.GetPathBuffer();
+    for (EdgeId edge_id = forward_workspace.GetPrevEdge(*meeting_vertex);
+         edge_id != Workspace::NO_EDGE;
+         edge_id = forward_workspace.GetPrevEdge(edges_[edge_id].from))
+    {
+        hierarchy_edges.push_back(edge_id);
+    }
+    std::reverse(hierarchy_edges.begin(), hierarchy_edges.end());
+    for (EdgeId edge_id = backward_workspace.GetPrevEdge(*meeting_vertex);
+         edge_id != Workspace::NO_EDGE;
+         edge_id = backward_workspace.GetPrevEdge(edges_[edge_id].to))
+    {
+        hierarchy_edges.push_back(edge_id);
+    }
+
+    auto& edges = route_info.edges;
+    edges.clear();
+    for (const EdgeId edge_id : hierarchy_edges) {
+        UnpackEdge(edge_id, edges, backward_workspace.GetPathBuffer());
+    }
+    route_info.weight = *best_weight;
+    return true;
+}
+
+// Bucket-based many-to-many: the backward search space of every target is stored in
+// per-vertex buckets, then a single forward search per source scans the buckets of the
+// vertices it settles.
+template <typename Weight>
+typename ContractionHierarchyRouter<Weight>::WeightMatrix
+ContractionHierarchyRouter<Weight>::BuildWeightMatrix(const std::vector<VertexId>& sources, const std::vector<VertexId>& targets,
+                                                      concurrency::ThreadPool& thread_pool) const {
+    const size_t vertex_count = forward_upward_graph_.GetVertexCount();
+    for (const VertexId vertex : sources) {
+        if (vertex >= vertex_count) {
+            throw std::out_of_range("Vertex id is out of range");
+        }
+    }
+    for (const VertexId vertex : targets) {
+        if (vertex >= vertex_count) {
+            throw std::out_of_range("Vertex id is out of range");
+        }
+    }
+
+    std::vector<std::vector<std::pair<VertexId, Weight>>> backward_search_spaces(targets.size());
+    thread_pool.ParallelFor(targets.size(), [&](size_t target_index) {
+        backward_search_spaces[target_index] = RunUpwardSearch(targets[target_index], backward_upward_graph_);
+    });
+
+    struct BucketEntry {
+        size_t target_index;
+        Weight weight;
+    };
+    std::vector<size_t> bucket_offsets(vertex_count + 1, 0);
+    for (const auto& search_space : backward_search_spaces) {
+        for (const auto& [vertex, weight] : search_space) {
+            ++bucket_offsets[vertex + 1];
+        }
+    }
+    for (size_t vertex = 0; vertex < vertex_count; ++vertex) {
+        bucket_offsets[vertex + 1] += bucket_offsets[vertex];
+    }
+    std::vector<BucketEntry> bucket_entries(bucket_offsets.back());
+    std::vector<size_t> positions(bucket_offsets.begin(), bucket_offsets.end() - 1);
+    for (size_t target_index = 0; target_index < targets.size(); ++target_index) {
+        for (const auto& [vertex, weight] : backward_search_spaces[target_index]) {
+            bucket_entries[positions[vertex]++] = {target_index, weight};
+        }
+    }
+    backward_search_spaces = {};
+
+    WeightMatrix weight_matrix(sources.size(), std::vector<std::optional<Weight>>(targets.size()));
+    thread_pool.ParallelFor(sources.size(), [&](size_t source_index) {
+        auto& weights = weight_matrix[source_index];
+        for (const auto& [vertex, weight] : RunUpwardSearch(sources[source_index], forward_upward_graph_)) {
+            for (size_t entry_index = bucket_offsets[vertex]; entry_index < bucket_offsets[vertex + 1]; ++entry_index) {
+                const auto& entry = bucket_entries[entry_index];
+                const Weight candidate_weight = weight + entry.weight;
+                if (!weights[entry.target_index] || candidate_weight < *weights[entry.target_index]) {
+                    weights[entry.target_index] = candidate_weight;
+                }
+            }
+        }
+    });
+    return weight_matrix;
+}
+
+template <typename Weight>
+std::vector<std::pair<VertexId, Weight>>
+ContractionHierarchyRouter<Weight>::RunUpwardSearch(VertexId start, const StaticGraph<Weight>& upward_graph) const {
+    auto& workspace = Workspace::Acquire(upward_graph.GetVertexCount());
+    std::vector<std::pair<VertexId, Weight>> settled_vertices;
+    workspace.Reach(start, ZERO_WEIGHT, Workspace::NO_EDGE);
+    workspace.PushQueue(ZERO_WEIGHT, start);
+    while (!workspace.IsQueueEmpty()) {
+        const auto [weight, vertex] = workspace.PopQueue();
+        if (weight > workspace.GetWeight(vertex)) {
+            continue;
+        }
+        settled_vertices.push_back({vertex, weight});
+        for (const auto& edge : upward_graph.GetIncidentEdges(vertex)) {
+            const Weight candidate_weight = weight + edge.weight;
+            if (!workspace.IsReached(edge.to) || candidate_weight < workspace.GetWeight(edge.to)) {
+                workspace.Reach(edge.to, candidate_weight, edge.edge_id);
+                workspace.PushQueue(candidate_weight, edge.to);
+            }
+        }
+    }
+    return settled_vertices;
+}
+
+template <typename Weight>
+void ContractionHierarchyRouter<Weight>::InitializeHierarchyEdges(const Graph& graph) {
+    edges_.reserve(graph.GetEdgeCount());
+    for (EdgeId edge_id = 0; edge_id < graph.GetEdgeCount(); ++edge_id) {
+        const auto& edge = graph.GetEdge(edge_id);
+        if (edge.weight < ZERO_WEIGHT) {
+            throw std::domain_error("Edges' weights should be non-negative");
+        }
+        edges_.push_back({edge.from, edge.to, edge.weight, std::nullopt});
+    }
+    // Removed edges keep their slots in edges_ but are not in the overlay.
+    for (VertexId vertex = 0; vertex < graph.GetVertexCount(); ++vertex) {
+        for (const EdgeId edge_id : graph.GetIncidentEdges(vertex)) {
+            const auto& edge = edges_[edge_id];
+            if (edge.from == edge.to) {
+                continue;
+            }
+            auto& outgoing_edges = overlay_outgoing_edges_[edge.from];
+            const auto it = std::find_if(outgoing_edges.begin(), outgoing_edges.end(), [&](EdgeId other_id) {
+                return edges_[other_id].to == edge.to;
+            });
+            if (it == outgoing_edges.end()) {
+                outgoing_edges.push_back(edge_id);
+                overlay_incoming_edges_[edge.to].push_back(edge_id);
+            } else if (edge.weight < edges_[*it].weight) {
+                EraseEdgeFrom(overlay_incoming_edges_[edge.to], edges_, edge.from);
+                overlay_incoming_edges_[edge.to].push_back(edge_id);
+                *it = edge_id;
+            }
+        }
+    }
+}
+
+template <typename Weight>
+void ContractionHierarchyRouter<Weight>::ContractVertices() {
+    const size_t vertex_count = is_contracted_.size();
+    std::vector<int> priorities(vertex_count);
+    using PriorityItem = std::pair<int, VertexId>;
+    std::priority_queue<PriorityItem, std::vector<PriorityItem>, std::greater<PriorityItem>> queue;
+    for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
+        priorities[vertex] = CalculateVertexPriority(vertex);
+        queue.push({priorities[vertex], vertex});
+    }
+
+    while (!queue.empty()) {
+        const auto [priority, vertex] = queue.top();
+        queue.pop();
+        if (is_contracted_[vertex] || priority != priorities[vertex]) {
+            continue;
+        }
+        // Lazy update: the stored priority may be stale after the neighbours were contracted.
+        priorities[vertex] = CalculateVertexPriority(vertex);
+        if (!queue.empty() && priorities[vertex] > queue.top().first) {
+            queue.push({priorities[vertex], vertex});
+            continue;
+        }
+
+        std::vector<VertexId> neighbors;
+        for (const EdgeId edge_id : overlay_outgoing_edges_[vertex]) {
+            neighbors.push_back(edges_[edge_id].to);
+        }
+        for (const EdgeId edge_id : overlay_incoming_edges_[vertex]) {
+            neighbors.push_back(edges_[edge_id].from);
+        }
+
+        ContractVertex(vertex, false);
+
+        std::sort(neighbors.begin(), neighbors.end());
+        neighbors.erase(std::unique(neighbors.begin(), neighbors.end()), neighbors.end());
+        // Neighbours only get the cheap "contracted neighbours" term here, the full
+        // recalculation happens lazily when they reach the top of the queue.
+        for (const VertexId neighbor : neighbors) {
+            ++contracted_neighbors_count_[neighbor];
+            ++priorities[neighbor];
+            queue.push({priorities[neighbor], neighbor});
+        }
+    }
+}
+
+template <typename Weight>
+void ContractionHierarchyRouter<Weight>::BuildUpwardGraphs(size_t vertex_count) {
+    using IncidentEdge = typename StaticGraph<Weight>::IncidentEdge;
+    std::vector<std::pair<VertexId, IncidentEdge>> forward_edges;
+    std::vector<std::pair<VertexId, IncidentEdge>> backward_edges;
+    for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
+        for (const EdgeId edge_id : upward_outgoing_edges_[vertex]) {
+            forward_edges.push_back({vertex, {edges_[edge_id].to, edges_[edge_id].weight, edge_id}});
+        }
+        for (const EdgeId edge_id : upward_incoming_edges_[vertex]) {
+            backward_edges.push_back({vertex, {edges_[edge_id].from, edges_[edge_id].weight, edge_id}});
+        }
+    }
+    forward_upward_graph_ = StaticGraph<Weight>(vertex_count, forward_edges);
+    backward_upward_graph_ = StaticGraph<Weight>(vertex_count, backward_edges);
+}
+
+template <typename Weight>
+int ContractionHierarchyRouter<Weight>::ContractVertex(VertexId vertex, bool is_simulation) {
+    int shortcuts_count = 0;
+    const auto incoming_edges = overlay_incoming_edges_[vertex];
+    const auto outgoing_edges = overlay_outgoing_edges_[vertex];
+    for (const EdgeId incoming_id : incoming_edges) {
+        const VertexId source = edges_[incoming_id].from;
+        const Weight incoming_weight = edges_[incoming_id].weight;
+
+        Weight max_weight = ZERO_WEIGHT;
+        for (const EdgeId outgoing_id : outgoing_edges) {
+            max_weight = std::max(max_weight, incoming_weight + edges_[outgoing_id].weight);
+        }
+        RunWitnessSearch(source, vertex, outgoing_edges, max_weight);
+
+        for (const EdgeId outgoing_id : outgoing_edges) {
+            const VertexId target = edges_[outgoing_id].to;
+            if (target == source) {
+                continue;
+            }
+            const Weight shortcut_weight = incoming_weight + edges_[outgoing_id].weight;
+            const auto& witness_weight = witness_weights_[target];
+            if (witness_weight && *witness_weight <= shortcut_weight) {
+                continue;
+            }
+            ++shortcuts_count;
+            if (!is_simulation) {
+                AddOrImproveEdge(source, target, shortcut_weight, std::pair{incoming_id, outgoing_id});
+            }
+        }
+    }
+
+    if (!is_simulation) {
+        is_contracted_[vertex] = true;
+        for (const EdgeId edge_id : overlay_incoming_edges_[vertex]) {
+            upward_incoming_edges_[vertex].push_back(edge_id);
+            EraseEdgeTo(overlay_outgoing_edges_[edges_[edge_id].from], edges_, vertex);
+        }
+        for (const EdgeId edge_id : overlay_outgoing_edges_[vertex]) {
+            upward_outgoing_edges_[vertex].push_back(edge_id);
+            EraseEdgeFrom(overlay_incoming_edges_[edges_[edge_id].to], edges_, vertex);
+        }
+        overlay_incoming_edges_[vertex].clear();
+        overlay_outgoing_edges_[vertex].clear();
+    }
+    return shortcuts_count;
+}
+
+template <typename Weight>
+int ContractionHierarchyRouter<Weight>::CalculateVertexPriority(VertexId vertex) {
+    const int shortcuts_count = ContractVertex(vertex, true);
+    const int removed_edges_count = static_cast<int>(overlay_incoming_edges_[vertex].size() + overlay_outgoing_edges_[vertex].size());
+    return shortcuts_count - removed_edges_count + contracted_neighbors_count_[vertex];
+}
+
+template <typename Weight>
+void ContractionHierarchyRouter<Weight>::RunWitnessSearch(VertexId source, VertexId vertex_excluded,
+                                                          const std::vector<EdgeId>& edges_to_targets, Weight max_weight) {
+    for (const VertexId vertex : witness_touched_vertices_) {
+        witness_weights_[vertex].reset();
+    }
+    witness_touched_vertices_.clear();
+
+    // The search is over as soon as every target is settled, so count the distinct ones.
+    size_t unsettled_targets_count = 0;
+    for (const EdgeId edge_id : edges_to_targets) {
+        const VertexId target = edges_[edge_id].to;
+        if (!is_witness_target_[target]) {
+            is_witness_target_[target] = true;
+            ++unsettled_targets_count;
+        }
+    }
+
+    Queue queue;
+    witness_weights_[source] = ZERO_WEIGHT;
+    witness_touched_vertices_.push_back(source);
+    queue.push({ZERO_WEIGHT, source});
+    size_t settled_count = 0;
+    while (!queue.empty() && settled_count < WITNESS_SEARCH_SETTLE_LIMIT && unsettled_targets_count > 0) {
+        const auto [weight, vertex] = queue.top();
+        queue.pop();
+        if (weight > *witness_weights_[vertex]) {
+            continue;
+        }
+        if (weight > max_weight) {
+            break;
+        }
+        ++settled_count;
+        if (is_witness_target_[vertex]) {
+            is_witness_target_[vertex] = false;
+            --unsettled_targets_count;
+        }
+        for (const EdgeId edge_id : overlay_outgoing_edges_[vertex]) {
+            const auto& edge = edges_[edge_id];
+            if (edge.to == vertex_excluded) {
+                continue;
+            }
+            const Weight candidate_weight = weight + edge.weight;
+            auto& next_weight = witness_weights_[edge.to];
+            if (!next_weight || candidate_weight < *next_weight) {
+                if (!next_weight) {
+                    witness_touched_vertices_.push_back(edge.to);
+                }
+                next_weight = candidate_weight;
+                queue.push({candidate_weight, edge.to});
+            }
+        }
+    }
+    for (const EdgeId edge_id : edges_to_targets) {
+        is_witness_target_[edges_[edge_id].to] = false;
+    }
+}
+
+template <typename Weight>
+void ContractionHierarchyRouter<Weight>::AddOrImproveEdge(VertexId from, VertexId to, Weight weight,
+                                                          std::optional<std::pair<EdgeId, EdgeId>> shortcut_edges) {
+    auto& outgoing_edges = overlay_outgoing_edges_[from];
+    const auto it = std::find_if(outgoing_edges.begin(), outgoing_edges.end(), [&](EdgeId edge_id) {
+        return edges_[edge_id].to == to;
+    });
+    if (it != outgoing_edges.end() && edges_[*it].weight <= weight) {
+        return;
+    }
+    edges_.push_back({from, to, weight, shortcut_edges});
+    const EdgeId edge_id = edges_.size() - 1;
+    if (it != outgoing_edges.end()) {
+        EraseEdgeFrom(overlay_incoming_edges_[to], edges_, from);
+        *it = edge_id;
+    } else {
+        outgoing_edges.push_back(edge_id);
+    }
+    overlay_incoming_edges_[to].push_back(edge_id);
+}
+
+template <typename Weight>
+void ContractionHierarchyRouter<Weight>::UnpackEdge(EdgeId edge_id, std::vector<EdgeId>& original_edges,
+                                                    std::vector<EdgeId>& edges_stack) const {
+    edges_stack.assign(1, edge_id);
+    while (!edges_stack.empty()) {
+        const EdgeId current_id = edges_stack.back();
+        edges_stack.pop_back();
+        if (const auto& shortcut_edges = edges_[current_id].shortcut_edges) {
+            edges_stack.push_back(shortcut_edges->second);
+            edges_stack.push_back(shortcut_edges->first);
+        } else {
+            original_edges.push_back(current_id);
+        }
+    }
+}
+
+template <typename Weight>
+void ContractionHierarchyRouter<Weight>::EraseEdgeTo(std::vector<EdgeId>& edge_ids, const std::vector<HierarchyEdge>& edges,
+                                                     VertexId vertex) {
+    edge_ids.erase(std::remove_if(edge_ids.begin(), edge_ids.end(), [&](EdgeId edge_id) {
+        return edges[edge_id].to == vertex;
+    }), edge_ids.end());
+}
+
+template <typename Weight>
+void ContractionHierarchyRouter<Weight>::EraseEdgeFrom(std::vector<EdgeId>& edge_ids, const std::vector<HierarchyEdge>& edges,
+                                                       VertexId vertex) {
+    edge_ids.erase(std::remove_if(edge_ids.begin(), edge_ids.end(), [&](EdgeId edge_id) {
+        return edges[edge_id].from == vertex;
+    }), edge_ids.end());
+}
+
+}  // namespace graph
@@ -0,0 +1,159 @@
+#pragma once
+
+#include "router.h"
+#include "search_workspace.h"
+#include "static_graph.h"
+
+#include <algorithm>
+#include <optional>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace graph {
+
+template <typename Weight>
+class DijkstraRouter : public RouterBase<Weight> {
+private:
+    using Graph = DirectedWeightedGraph<Weight>;
+
+public:
+    using RouteInfo = typename RouterBase<Weight>::RouteInfo;
+    using WeightMatrix = typename RouterBase<Weight>::WeightMatrix;
+
+    explicit DijkstraRouter(const Graph& graph);
+
+    bool FillRoute(VertexId from, VertexId to, RouteInfo& route_info) const override;
+    WeightMatrix BuildWeightMatrix(const std::vector<VertexId>& sources, const std::vector<VertexId>& targets,
+                                   concurrency::ThreadPool& thread_pool) const override;
+
+private:
+    using Workspace = SearchWorkspace<Weight>;
+
+    static constexpr Weight ZERO_WEIGHT{};
+    const Graph& graph_;
+    StaticGraph<Weight> static_graph_;
+};
+
+template <typename Weight>
+DijkstraRouter<Weight>::DijkstraRouter(const Graph& graph)
+    : graph_(graph)
+    , static_graph_(graph)
+{
+    for (VertexId vertex = 0; vertex < static_graph_.GetVertexCount(); ++vertex) {
+        for (const auto& edge : static_graph_.GetIncidentEdges(vertex)) {
+            if (edge.weight < ZERO_WEIGHT) {
+                throw std::domain_error("Edges' weights should be non-negative");
+            }
+        }
+    }
+}
+
+template <typename Weight>
+bool DijkstraRouter<Weight>::FillRoute(VertexId from, VertexId to, RouteInfo& route_info) const {
+    const size_t vertex_count = static_graph_.GetVertexCount();
+    if (from >= vertex_count || to >= vertex_count) {
+        throw std::out_of_range("Vertex id is out of range");
+    }
+    auto& workspace = Workspace::Acquire(vertex_count);
+    workspace.Reach(from, ZERO_WEIGHT, Workspace::NO_EDGE);
+    workspace.PushQueue(ZERO_WEIGHT, from);
+
+    while (!workspace.IsQueueEmpty()) {
+        const auto [weight, vertex] = workspace.PopQueue();
+        if (workspace.IsSettled(vertex)) {
+            continue;
+        }
+        workspace.Settle(vertex);
+        if (vertex == to) {
+            break;
+        }
+        for (const auto& edge : static_graph_.GetIncidentEdges(vertex)) {
+            const Weight candidate_weight = weight + edge.weight;
+            if (!workspace.IsSettled(edge.to)
+                && (!workspace.IsReached(edge.to) || candidate_weight < workspace.GetWeight(edge.to))) {
+                workspace.Reach(edge.to, candidate_weight, edge.edge_id);
+                workspace.PushQueue(candidate_weight, edge.to);
+            }
+        }
+    }
+
+    if (!workspace.IsReached(to)) {
+        return false;
+    }
+    auto& edges = route_info.edges;
+    edges.clear();
+    for (EdgeId edge_id = workspace.GetPrevEdge(to);
+         edge_id != Workspace::NO_EDGE;
+         edge_id = workspace.GetPrevEdge(graph_.GetEdge(edge_id).from))
+    {
+        edges.push_back(edge_id);
+    }
+    std::reverse(edges.begin(), edges.end());
+    route_info.weight = workspace.GetWeight(to);
+    return true;
+}
+
+template <typename Weight>
+typename DijkstraRouter<Weight>::WeightMatrix DijkstraRouter<Weight>::BuildWeightMatrix(const std::vector<VertexId>& sources,
+                                                                                        const std::vector<VertexId>& targets,
+                                                                                        concurrency::ThreadPool& thread_pool) const {
+    const size_t vertex_count = static_graph_.GetVertexCount();
+    for (const VertexId vertex : sources) {
+        if (vertex >= vertex_count) {
+            throw std::out_of_range("Vertex id is out of range");
+        }
+    }
+    for (const VertexId vertex : targets) {
+        if (vertex >= vertex_count) {
+            throw std::out_of_range("Vertex id is out of range");
+        }
+    }
+
+    // The targets are the same for every row, so they are marked once and only read by the rows.
+    std::vector<bool> is_target(vertex_count, false);
+    size_t distinct_targets_count = 0;
+    for (const VertexId target : targets) {
+        if (!is_target[target]) {
+            is_target[target] = true;
+            ++distinct_targets_count;
+        }
+    }
+
+    WeightMatrix weight_matrix(sources.size(), std::vector<std::optional<Weight>>(targets.size()));
+    thread_pool.ParallelFor(sources.size(), [&](size_t source_index) {
+        // One search from the source, it stops as soon as every target is settled.
+        auto& workspace = Workspace::Acquire(vertex_count);
+        size_t unsettled_targets_count = distinct_targets_count;
+        workspace.Reach(sources[source_index], ZERO_WEIGHT, Workspace::NO_EDGE);
+        workspace.PushQueue(ZERO_WEIGHT, sources[source_index]);
+        while (!workspace.IsQueueEmpty() && unsettled_targets_count > 0) {
+            const auto [weight, vertex] = workspace.PopQueue();
+            if (workspace.IsSettled(vertex)) {
+                continue;
+            }
+            workspace.Settle(vertex);
+            if (is_target[vertex]) {
+                --unsettled_targets_count;
+            }
+            for (const auto& edge : static_graph_.GetIncidentEdges(vertex)) {
+                const Weight candidate_weight = weight + edge.weight;
+                if (!workspace.IsSettled(edge.to)
+                    && (!workspace.IsReached(edge.to) || candidate_weight < workspace.GetWeight(edge.to))) {
+                    workspace.Reach(edge.to, candidate_weight, edge.edge_id);
+                    workspace.PushQueue(candidate_weight, edge.to);
+                }
+            }
+        }
+
+        for (size_t target_index = 0; target_index < targets.size(); ++target_index) {
+            const VertexId target = targets[target_index];
+            if (workspace.IsReached(target)) {
+                weight_matrix[source_index][target_index] = workspace.GetWeight(target);
+            }
+        }
+    });
+    return weight_matrix;
+}
+
+}  // namespace graph
@@ -0,0 +1,76 @@
+#include "distance_table.h"
+
+#include <utility>
+
+namespace transport {
+
+void DistanceTable::Reserve(size_t distance_count) {
+    size_t capacity = MIN_CAPACITY;
+    while (capacity < 2 * distance_count) {
+        capacity *= 2;
+    }
+    if (capacity > slots_.size()) {
+        Rehash(capacity);
+    }
+}
+
+void DistanceTable::Set(StopId stop_from, StopId stop_to, int distance) {
+    if (2 * (size_ + 1) > slots_.size()) {
+        Rehash(slots_.empty() ? MIN_CAPACITY : 2 * slots_.size());
+    }
+    const uint64_t key = PackKey(stop_from, stop_to);
+    Slot& slot = slots_[FindSlotIndex(key)];
+    if (slot.key == EMPTY_KEY) {
+        slot.key = key;
+        ++size_;
+    }
+    slot.distance = distance;
+}
+
+std::optional<int> DistanceTable::Find(StopId stop_from, StopId stop_to) const {
+    if (slots_.empty()) {
+        return std::nullopt;
+    }
+    if (const Slot& slot = slots_[FindSlotIndex(PackKey(stop_from, stop_to))]; slot.key != EMPTY_KEY) {
+        return slot.distance;
+    }
+    if (const Slot& slot = slots_[FindSlotIndex(PackKey(stop_to, stop_from))]; slot.key != EMPTY_KEY) {
+        return slot.distance;
+    }
+    return std::nullopt;
+}
+
+size_t DistanceTable::GetSize() const {
+    return size_;
+}
+
+uint64_t DistanceTable::PackKey(StopId stop_from, StopId stop_to) {
+    return (static_cast<uint64_t>(stop_from) << 32) | stop_to;
+}
+
+// Fibonacci hashing: the top bits of the product mix both ids. Returns the slot of the key
+// or the empty slot where it would go.
+size_t DistanceTable::FindSlotIndex(uint64_t key) const {
+    const size_t mask = slots_.size() - 1;
+    size_t index = (key * 0x9E3779B97F4A7C15ull) >> index_shift_;
+    while (slots_[index].key != key && slots_[index].key != EMPTY_KEY) {
+        index = (index + 1) & mask;
+    }
+    return index;
+}
+
+void DistanceTable::Rehash(size_t capacity) {
+    std::vector<Slot> old_slots(capacity);
+    std::swap(old_slots, slots_);
+    index_shift_ = 64;
+    for (size_t size = 1; size < capacity; size *= 2) {
+        --index_shift_;
+    }
+    for (const Slot& slot : old_slots) {
+        if (slot.key != EMPTY_KEY) {
+            slots_[FindSlotIndex(slot.key)] = slot;
+        }
+    }
+}
+
+} // namespace transport
@@ -0,0 +1,43 @@
+#pragma once
+
+#include "domain.h"
+
+#include <cstdint>
+#include <cstdlib>
+#include <optional>
+#include <vector>
+
+namespace transport {
+
+// Road distances between stops in one flat array with linear probing, the key packs the ids
+// of both stops into 64 bits. A distance is stored once, for the direction it was given in;
+// the opposite direction falls back to it until it is given too.
+class DistanceTable {
+public:
+    // Sizes the table for distance_count distances, so adding them does not rehash.
+    void Reserve(size_t distance_count);
+    void Set(StopId stop_from, StopId stop_to, int distance);
+    std::optional<int> Find(StopId stop_from, StopId stop_to) const;
+    size_t GetSize() const;
+
+private:
+    // Both ids at their maximum can't be a key: the ids are dense.
+    static constexpr uint64_t EMPTY_KEY = UINT64_MAX;
+    static constexpr size_t MIN_CAPACITY = 16;
+
+    struct Slot {
+        uint64_t key = EMPTY_KEY;
+        int distance = 0;
+    };
+
+    static uint64_t PackKey(StopId stop_from, StopId stop_to);
+    size_t FindSlotIndex(uint64_t key) const;
+    void Rehash(size_t capacity);
+
+    // The capacity is a power of two and at least twice the size.
+    std::vector<Slot> slots_;
+    size_t size_ = 0;
+    int index_shift_ = 64;
+};
+
+} // namespace transport
@@ -2,20 +2,31 @@
 
 #include "geo.h"
 
-#include <string>
+#include <cstdint>
+#include <string_view>
 #include <vector>
 
 namespace transport {
+
+// Stops and routes are numbered densely in the order they are added to the catalogue.
+using StopId = uint32_t;
+using RouteId = uint32_t;
     
+// The names are views into the NameArena of the catalogue.
 struct Stop {
-    std::string name;
+    StopId id = 0;
+    std::string_view name;
     geo::Coordinates coordinates;
 };
 
 struct Route {
-    std::string name;
-    std::vector<std::string> stops;
+    RouteId id = 0;
+    std::string_view name;
+    std::vector<StopId> stops;
     bool is_roundtrip = false;
+    // Departures from the first stop in minutes from the start of the day, empty if the bus
+    // has no timetable. The return trips of a non-roundtrip bus follow the forward ones.
+    std::vector<double> departure_times = {};
 };
  
 } // namespace transport
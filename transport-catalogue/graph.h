@@ -2,6 +2,7 @@
 
 #include "ranges.h"
 
+#include <algorithm>
 #include <cstdlib>
 #include <vector>
 
@@ -27,6 +28,16 @@ public:
     DirectedWeightedGraph() = default;
     explicit DirectedWeightedGraph(size_t vertex_count);
     EdgeId AddEdge(const Edge<Weight>& edge);
+    VertexId AddVertex();
+    // The edge leaves the incidence list of its source but keeps its id: GetEdge still
+    // returns it and the ids of the other edges stay valid. Code that walks the edges
+    // should go through GetIncidentEdges to skip removed ones.
+    void RemoveEdge(EdgeId edge_id);
+    // RemoveEdge for every edge leaving the vertex that the predicate holds for, in one pass.
+    template <typename Predicate>
+    void RemoveIncidentEdgesIf(VertexId vertex, Predicate predicate);
+    // Puts a removed edge back at the end of the incidence list of its source.
+    void RestoreEdge(EdgeId edge_id);
 
     size_t GetVertexCount() const;
     size_t GetEdgeCount() const;
@@ -51,6 +62,30 @@ EdgeId DirectedWeightedGraph<Weight>::AddEdge(const Edge<Weight>& edge) {
     return id;
 }
 
+template <typename Weight>
+VertexId DirectedWeightedGraph<Weight>::AddVertex() {
+    incidence_lists_.emplace_back();
+    return incidence_lists_.size() - 1;
+}
+
+template <typename Weight>
+void DirectedWeightedGraph<Weight>::RemoveEdge(EdgeId edge_id) {
+    IncidenceList& incidence_list = incidence_lists_.at(edges_.at(edge_id).from);
+    incidence_list.erase(std::remove(incidence_list.begin(), incidence_list.end(), edge_id), incidence_list.end());
+}
+
+template <typename Weight>
+template <typename Predicate>
+void DirectedWeightedGraph<Weight>::RemoveIncidentEdgesIf(VertexId vertex, Predicate predicate) {
+    IncidenceList& incidence_list = incidence_lists_.at(vertex);
+    incidence_list.erase(std::remove_if(incidence_list.begin(), incidence_list.end(), predicate), incidence_list.end());
+}
+
+template <typename Weight>
+void DirectedWeightedGraph<Weight>::RestoreEdge(EdgeId edge_id) {
+    incidence_lists_.at(edges_.at(edge_id).from).push_back(edge_id);
+}
+
 template <typename Weight>
 size_t DirectedWeightedGraph<Weight>::GetVertexCount() const {
     return incidence_lists_.size();
@@ -1,8 +1,11 @@
 #include "json_builder.h"
 #include "json_reader.h"
 
+#include <algorithm>
+#include <limits>
 #include <set>
 #include <sstream>
+#include <stdexcept>
 
 using namespace std::literals;
 
@@ -11,6 +14,8 @@ void JsonReader::FillCatalogue(transport::TransportCatalogue& catalogue) const {
     FillCatalogueWithStops(base_requests_array, catalogue);
     FillCatalogueWithDistances(base_requests_array, catalogue);
     FillCatalogueWithRoutes(base_requests_array, catalogue);
+    catalogue.BuildSpatialIndex();
+    catalogue.BuildNameSearchIndex();
 }
 
 void JsonReader::FillRenderer(MapRenderer& renderer) const {
@@ -31,15 +36,32 @@ void JsonReader::FillRenderer(MapRenderer& renderer) const {
                           ReadArrayColorFromJson(render_settings_map.at("color_palette"s).AsArray())});
 }
 
-void JsonReader::FillTransportRouter(transport::TransportRouter& transport_router) const {
+transport::RoutingSettings JsonReader::ReadRoutingSettings() const {
     const auto& routing_settings_map = requests_doc_.GetRoot().AsDict().at("routing_settings"s).AsDict();
-    transport_router.SetSettings({routing_settings_map.at("bus_velocity"s).AsDouble(),
-                                  routing_settings_map.at("bus_wait_time"s).AsInt()});
+    return {routing_settings_map.at("bus_velocity"s).AsDouble(),
+            ReadBusWaitTimeFromJson(routing_settings_map),
+            ReadRouterModeFromJson(routing_settings_map),
+            ReadGraphModelFromJson(routing_settings_map),
+            ReadPathCacheCapacityFromJson(routing_settings_map),
+            ReadLandmarkCountFromJson(routing_settings_map),
+            routing_settings_map.count("cache_directory"s)
+                ? routing_settings_map.at("cache_directory"s).AsString() : ""s,
+            routing_settings_map.count("prune_parallel_edges"s)
+                ? routing_settings_map.at("prune_parallel_edges"s).AsBool() : false,
+            routing_settings_map.count("keep_edge_alternatives"s)
+                ? routing_settings_map.at("keep_edge_alternatives"s).AsBool() : false,
+            ReadVertexOrderFromJson(routing_settings_map),
+            ReadWeightTypeFromJson(routing_settings_map)};
+}
+
+void JsonReader::FillTransportRouter(transport::TransportRouterBase& transport_router) const {
+    transport_router.SetSettings(ReadRoutingSettings());
 }
 
 void JsonReader::PrintRequestsResults(const RequestHandler& handler, std::ostream& out) const {
     json::Array result;
     const auto& stat_requests_array = requests_doc_.GetRoot().AsDict().at("stat_requests"s).AsArray();
+    transport::PathInfo path_info;
     for (const auto& stat_request : stat_requests_array) {
         const auto& stat_request_map = stat_request.AsDict();
         if (stat_request_map.at("type"s).AsString() == "Bus"s) {
@@ -56,8 +78,36 @@ void JsonReader::PrintRequestsResults(const RequestHandler& handler, std::ostrea
         if (stat_request_map.at("type"s).AsString() == "Route"s) {
             result.push_back(GetPathRequestResult(stat_request_map.at("from"s).AsString(),
                                                   stat_request_map.at("to"s).AsString(),
-                                                  stat_request_map.at("id"s).AsInt(), handler));
+                                                  stat_request_map.count("departure_time"s)
+                                                      ? stat_request_map.at("departure_time"s).AsDouble() : 0.0,
+                                                  stat_request_map.at("id"s).AsInt(), handler, path_info));
         }        
+        if (stat_request_map.at("type"s).AsString() == "RouteOptions"s) {
+            result.push_back(GetParetoPathsRequestResult(stat_request_map.at("from"s).AsString(),
+                                                         stat_request_map.at("to"s).AsString(),
+                                                         stat_request_map.count("departure_time"s)
+                                                             ? stat_request_map.at("departure_time"s).AsDouble() : 0.0,
+                                                         stat_request_map.at("id"s).AsInt(), handler));
+        }
+        if (stat_request_map.at("type"s).AsString() == "Isochrone"s) {
+            result.push_back(GetIsochroneRequestResult(stat_request_map, handler));
+        }
+        if (stat_request_map.at("type"s).AsString() == "Matrix"s) {
+            result.push_back(GetMatrixRequestResult(stat_request_map.at("from"s).AsArray(),
+                                                    stat_request_map.at("to"s).AsArray(),
+                                                    stat_request_map.count("departure_time"s)
+                                                        ? stat_request_map.at("departure_time"s).AsDouble() : 0.0,
+                                                    stat_request_map.at("id"s).AsInt(), handler));
+        }
+        if (stat_request_map.at("type"s).AsString() == "Nearby"s) {
+            result.push_back(GetNearbyRequestResult(stat_request_map, handler));
+        }
+        if (stat_request_map.at("type"s).AsString() == "StopsInBox"s) {
+            result.push_back(GetStopsInBoxRequestResult(stat_request_map, handler));
+        }
+        if (stat_request_map.at("type"s).AsString() == "Search"s) {
+            result.push_back(GetSearchRequestResult(stat_request_map, handler));
+        }
     }
     json::Print(json::Document{result}, out);
 }
@@ -80,6 +130,14 @@ void JsonReader::FillCatalogueWithStops(const json::Array& base_requests,
 
 void JsonReader::FillCatalogueWithDistances(const json::Array& base_requests, 
                                                   transport::TransportCatalogue& catalogue) const {
+    size_t distance_count = 0;
+    for (const auto& base_request : base_requests) {
+        const auto& base_request_map = base_request.AsDict();
+        if (base_request_map.at("type"s).AsString() == "Stop"s) {
+            distance_count += base_request_map.at("road_distances"s).AsDict().size();
+        }
+    }
+    catalogue.ReserveDistances(distance_count);
     for (const auto& base_request : base_requests) {
         const auto& base_request_map = base_request.AsDict();
         if (base_request_map.at("type"s).AsString() == "Stop"s) {
@@ -95,12 +153,13 @@ void JsonReader::FillCatalogueWithRoutes(const json::Array& base_requests,
     for (const auto& base_request : base_requests) {        
         const auto& base_request_map = base_request.AsDict();                
         if (base_request_map.at("type"s).AsString() == "Bus"s) {
-            std::vector<std::string> stops_in_route;
+            std::vector<std::string_view> stops_in_route;
             for (const auto& stop : base_request_map.at("stops"s).AsArray()) {
                 stops_in_route.push_back(stop.AsString());
             }        
             catalogue.AddRoute(base_request_map.at("name"s).AsString(), stops_in_route, 
-                               base_request_map.at("is_roundtrip"s).AsBool());    
+                               base_request_map.at("is_roundtrip"s).AsBool(),
+                               ReadDepartureTimesFromJson(base_request_map));    
         }            
     }    
 }
@@ -133,22 +192,149 @@ std::vector<svg::Color> JsonReader::ReadArrayColorFromJson(std::vector<json::Nod
     return colors;
 }
 
+// Zero is allowed: the wait/ride graph gets zero-weight cycles then, which the routers handle.
+int JsonReader::ReadBusWaitTimeFromJson(const json::Dict& routing_settings_map) const {
+    const int bus_wait_time = routing_settings_map.at("bus_wait_time"s).AsInt();
+    if (bus_wait_time < 0) {
+        throw std::invalid_argument("Bus wait time should be non-negative: "s + std::to_string(bus_wait_time));
+    }
+    return bus_wait_time;
+}
+
+size_t JsonReader::ReadPathCacheCapacityFromJson(const json::Dict& routing_settings_map) const {
+    if (!routing_settings_map.count("path_cache_capacity"s)) {
+        return 0;
+    }
+    const int path_cache_capacity = routing_settings_map.at("path_cache_capacity"s).AsInt();
+    if (path_cache_capacity < 0) {
+        throw std::invalid_argument("Path cache capacity should be non-negative: "s
+                                    + std::to_string(path_cache_capacity));
+    }
+    return static_cast<size_t>(path_cache_capacity);
+}
+
+size_t JsonReader::ReadLandmarkCountFromJson(const json::Dict& routing_settings_map) const {
+    if (!routing_settings_map.count("landmark_count"s)) {
+        return transport::RoutingSettings{}.landmark_count;
+    }
+    const int landmark_count = routing_settings_map.at("landmark_count"s).AsInt();
+    if (landmark_count < 1) {
+        throw std::invalid_argument("Landmark count should be positive: "s + std::to_string(landmark_count));
+    }
+    return static_cast<size_t>(landmark_count);
+}
+
+transport::RouterMode JsonReader::ReadRouterModeFromJson(const json::Dict& routing_settings_map) const {
+    if (!routing_settings_map.count("router_mode"s)) {
+        return transport::RouterMode::PRECOMPUTED;
+    }
+    const std::string& router_mode = routing_settings_map.at("router_mode"s).AsString();
+    if (router_mode == "precomputed"s) {
+        return transport::RouterMode::PRECOMPUTED;
+    }
+    if (router_mode == "on_demand"s) {
+        return transport::RouterMode::ON_DEMAND;
+    }
+    if (router_mode == "contraction_hierarchy"s) {
+        return transport::RouterMode::CONTRACTION_HIERARCHY;
+    }
+    if (router_mode == "landmarks"s) {
+        return transport::RouterMode::LANDMARKS;
+    }
+    if (router_mode == "raptor"s) {
+        return transport::RouterMode::RAPTOR;
+    }
+    throw std::invalid_argument("Unknown router mode: "s + router_mode);
+}
+
+transport::GraphModel JsonReader::ReadGraphModelFromJson(const json::Dict& routing_settings_map) const {
+    if (!routing_settings_map.count("graph_model"s)) {
+        return transport::GraphModel::STOP_TO_STOP;
+    }
+    const std::string& graph_model = routing_settings_map.at("graph_model"s).AsString();
+    if (graph_model == "stop_to_stop"s) {
+        return transport::GraphModel::STOP_TO_STOP;
+    }
+    if (graph_model == "wait_ride"s) {
+        return transport::GraphModel::WAIT_RIDE;
+    }
+    throw std::invalid_argument("Unknown graph model: "s + graph_model);
+}
+
+transport::VertexOrder JsonReader::ReadVertexOrderFromJson(const json::Dict& routing_settings_map) const {
+    if (!routing_settings_map.count("vertex_order"s)) {
+        return transport::VertexOrder::NONE;
+    }
+    const std::string& vertex_order = routing_settings_map.at("vertex_order"s).AsString();
+    if (vertex_order == "none"s) {
+        return transport::VertexOrder::NONE;
+    }
+    if (vertex_order == "hilbert"s) {
+        return transport::VertexOrder::HILBERT;
+    }
+    if (vertex_order == "rcm"s) {
+        return transport::VertexOrder::REVERSE_CUTHILL_MCKEE;
+    }
+    throw std::invalid_argument("Unknown vertex order: "s + vertex_order);
+}
+
+// A bus timetable is either the list of "departures" or a "headway" between "first_departure"
+// and "last_departure", all in minutes from the start of the day.
+transport::WeightType JsonReader::ReadWeightTypeFromJson(const json::Dict& routing_settings_map) const {
+    if (!routing_settings_map.count("weight_type"s)) {
+        return transport::WeightType::DOUBLE;
+    }
+    const std::string& weight_type = routing_settings_map.at("weight_type"s).AsString();
+    if (weight_type == "double"s) {
+        return transport::WeightType::DOUBLE;
+    }
+    if (weight_type == "float"s) {
+        return transport::WeightType::FLOAT;
+    }
+    if (weight_type == "int32"s) {
+        return transport::WeightType::INT32;
+    }
+    throw std::invalid_argument("Unknown weight type: "s + weight_type);
+}
+
+std::vector<double> JsonReader::ReadDepartureTimesFromJson(const json::Dict& bus_request_map) const {
+    std::vector<double> departure_times;
+    if (bus_request_map.count("departures"s)) {
+        for (const auto& departure_time : bus_request_map.at("departures"s).AsArray()) {
+            departure_times.push_back(departure_time.AsDouble());
+        }
+    } else if (bus_request_map.count("headway"s)) {
+        const double headway = bus_request_map.at("headway"s).AsDouble();
+        if (headway <= 0.0) {
+            throw std::invalid_argument("Headway should be positive, bus: "s + bus_request_map.at("name"s).AsString());
+        }
+        const double first_departure = bus_request_map.count("first_departure"s)
+                                       ? bus_request_map.at("first_departure"s).AsDouble() : 0.0;
+        const double last_departure = bus_request_map.count("last_departure"s)
+                                      ? bus_request_map.at("last_departure"s).AsDouble() : 24.0 * 60.0;
+        for (double departure_time = first_departure; departure_time <= last_departure; departure_time += headway) {
+            departure_times.push_back(departure_time);
+        }
+    }
+    return departure_times;
+}
+
 json::Node JsonReader::GetRouteRequestResult(std::string_view bus_name, int request_id, 
                                              const RequestHandler& handler) const {
-    if (!handler.GetBusStat(bus_name)) {
+    const auto route_info = handler.GetBusStat(bus_name);
+    if (!route_info) {
         return json::Builder{}.StartDict()
                                   .Key("request_id"s).Value(request_id)
                                   .Key("error_message"s).Value("not found"s)
                               .EndDict()
                               .Build();
     }
-    const auto route_info = *handler.GetBusStat(bus_name);
     return json::Builder{}.StartDict()
                               .Key("request_id"s).Value(request_id)
-                              .Key("stop_count"s).Value(route_info.number_of_stops)
-                              .Key("unique_stop_count"s).Value(route_info.number_of_unique_stops)
-                              .Key("route_length"s).Value(route_info.length)
-                              .Key("curvature"s).Value(route_info.curvature)
+                              .Key("stop_count"s).Value(route_info->number_of_stops)
+                              .Key("unique_stop_count"s).Value(route_info->number_of_unique_stops)
+                              .Key("route_length"s).Value(route_info->length)
+                              .Key("curvature"s).Value(route_info->curvature)
                           .EndDict()
                           .Build();      
 }
@@ -185,36 +371,190 @@ json::Node JsonReader::GetMapRequestResult(int request_id, const RequestHandler&
                           .Build();
 }
 
-json::Node JsonReader::GetPathRequestResult(std::string_view stop_from, std::string_view stop_to, 
-                                            int request_id, const RequestHandler& handler) const {
-    if (!handler.GetPathBetweenTwoStops(stop_from, stop_to)) {
+// path_info is kept between the requests, so finding the path reuses its memory, the answer
+// itself is built anew.
+json::Node JsonReader::GetPathRequestResult(std::string_view stop_from, std::string_view stop_to, double departure_time,
+                                            int request_id, const RequestHandler& handler,
+                                            transport::PathInfo& path_info) const {
+    if (!handler.GetPathBetweenTwoStops(stop_from, stop_to, departure_time, path_info)) {
         return json::Builder{}.StartDict()
                                   .Key("request_id"s).Value(request_id)
                                   .Key("error_message"s).Value("not found"s)
                               .EndDict()
                               .Build();
     }
-    const auto path_info = *handler.GetPathBetweenTwoStops(stop_from, stop_to);
+    return json::Builder{}.StartDict()
+                              .Key("request_id"s).Value(request_id)
+                              .Key("total_time"s).Value(path_info.total_time)
+                              .Key("items"s).Value(GetPathItems(path_info))
+                          .EndDict()
+                          .Build();    
+}
+
+json::Node JsonReader::GetParetoPathsRequestResult(std::string_view stop_from, std::string_view stop_to, double departure_time,
+                                                   int request_id, const RequestHandler& handler) const {
+    const auto paths = handler.GetParetoPathsBetweenTwoStops(stop_from, stop_to, departure_time);
+    if (paths.empty()) {
+        return json::Builder{}.StartDict()
+                                  .Key("request_id"s).Value(request_id)
+                                  .Key("error_message"s).Value("not found"s)
+                              .EndDict()
+                              .Build();
+    }
+    json::Array routes;
+    for (const auto& path_info : paths) {
+        routes.emplace_back(json::Builder{}.StartDict()
+                                               .Key("total_time"s).Value(path_info.total_time)
+                                               .Key("transfer_count"s).Value(path_info.items.empty()
+                                                                             ? 0 : static_cast<int>(path_info.items.size()) - 1)
+                                               .Key("items"s).Value(GetPathItems(path_info))
+                                           .EndDict()
+                                           .Build());
+    }
+    return json::Builder{}.StartDict()
+                              .Key("request_id"s).Value(request_id)
+                              .Key("routes"s).Value(std::move(routes))
+                          .EndDict()
+                          .Build();
+}
+
+// Every reachable stop is a compact [name, time] pair, "map" is added if "render" is true.
+json::Node JsonReader::GetIsochroneRequestResult(const json::Dict& stat_request_map, const RequestHandler& handler) const {
+    const double max_time = stat_request_map.at("max_time"s).AsDouble();
+    const auto reachable_stops = handler.GetReachableStops(stat_request_map.at("from"s).AsString(), max_time,
+                                                           stat_request_map.count("departure_time"s)
+                                                               ? stat_request_map.at("departure_time"s).AsDouble() : 0.0);
+    json::Array stops;
+    stops.reserve(reachable_stops.size());
+    for (const auto& reachable_stop : reachable_stops) {
+        stops.emplace_back(json::Array{json::Node(std::string(reachable_stop.stop_name)), json::Node(reachable_stop.time)});
+    }
+    json::Builder builder;
+    builder.StartDict()
+               .Key("request_id"s).Value(stat_request_map.at("id"s).AsInt())
+               .Key("stops"s).Value(std::move(stops));
+    if (stat_request_map.count("render"s) && stat_request_map.at("render"s).AsBool()) {
+        std::ostringstream oss;
+        handler.RenderReachableStops(reachable_stops, max_time).Render(oss);
+        builder.Key("map"s).Value(oss.str());
+    }
+    return builder.EndDict().Build();
+}
+
+json::Array JsonReader::GetPathItems(const transport::PathInfo& path_info) const {
     json::Array items;
     for (auto& item : path_info.items) {
         items.emplace_back(json::Builder{}.StartDict()
                                               .Key("type"s).Value("Wait"s)
                                               .Key("stop_name"s).Value(std::string(item.start_stop))
-                                              .Key("time"s).Value(path_info.bus_wait_time)
+                                              .Key("time"s).Value(item.wait_time)
                                           .EndDict()
                                           .Build());
+        json::Builder builder;
+        builder.StartDict()
+                   .Key("type"s).Value("Bus"s)
+                   .Key("bus"s).Value(std::string(item.bus_name))
+                   .Key("span_count"s).Value(item.span_count)
+                   .Key("time"s).Value(item.weight);
+        if (!item.alternative_buses.empty()) {
+            json::Array alternative_buses;
+            for (const std::string_view bus_name : item.alternative_buses) {
+                alternative_buses.emplace_back(std::string(bus_name));
+            }
+            builder.Key("alternative_buses"s).Value(std::move(alternative_buses));
+        }
+        items.emplace_back(builder.EndDict().Build());
+    }
+    return items;
+}
+
+json::Node JsonReader::GetMatrixRequestResult(const json::Array& stops_from, const json::Array& stops_to, double departure_time,
+                                              int request_id, const RequestHandler& handler) const {
+    std::vector<std::string_view> stops_from_names;
+    std::vector<std::string_view> stops_to_names;
+    for (const auto& stop : stops_from) {
+        stops_from_names.push_back(stop.AsString());
+    }
+    for (const auto& stop : stops_to) {
+        stops_to_names.push_back(stop.AsString());
+    }
+    const auto time_matrix = handler.GetTravelTimeMatrix(stops_from_names, stops_to_names, departure_time);
+    if (!time_matrix) {
+        return json::Builder{}.StartDict()
+                                  .Key("request_id"s).Value(request_id)
+                                  .Key("error_message"s).Value("not found"s)
+                              .EndDict()
+                              .Build();
+    }
+    json::Array times;
+    for (const auto& time_row : *time_matrix) {
+        json::Array times_row;
+        for (const auto& time : time_row) {
+            times_row.emplace_back(time ? json::Node(*time) : json::Node(nullptr));
+        }
+        times.emplace_back(std::move(times_row));
+    }
+    return json::Builder{}.StartDict()
+                              .Key("request_id"s).Value(request_id)
+                              .Key("times"s).Value(std::move(times))
+                          .EndDict()
+                          .Build();
+}
+
+// Without a radius the nearest stop is asked for, with a radius all stops within it.
+json::Node JsonReader::GetNearbyRequestResult(const json::Dict& stat_request_map, const RequestHandler& handler) const {
+    const bool has_radius = stat_request_map.count("radius"s) > 0;
+    const double radius = has_radius ? stat_request_map.at("radius"s).AsDouble() : std::numeric_limits<double>::infinity();
+    const size_t count = stat_request_map.count("count"s)
+                         ? static_cast<size_t>(std::max(0, stat_request_map.at("count"s).AsInt()))
+                         : (has_radius ? std::numeric_limits<size_t>::max() : 1);
+    const auto nearest_stops = handler.GetNearestStops({stat_request_map.at("latitude"s).AsDouble(),
+                                                        stat_request_map.at("longitude"s).AsDouble()},
+                                                       count, radius);
+    json::Array stops;
+    stops.reserve(nearest_stops.size());
+    for (const auto& [stop, distance] : nearest_stops) {
+        stops.emplace_back(json::Array{json::Node(std::string(stop->name)), json::Node(distance)});
+    }
+    return json::Builder{}.StartDict()
+                              .Key("request_id"s).Value(stat_request_map.at("id"s).AsInt())
+                              .Key("stops"s).Value(std::move(stops))
+                          .EndDict()
+                          .Build();
+}
+
+json::Node JsonReader::GetStopsInBoxRequestResult(const json::Dict& stat_request_map, const RequestHandler& handler) const {
+    const auto stops_in_box = handler.GetStopsInBox({stat_request_map.at("min_latitude"s).AsDouble(),
+                                                     stat_request_map.at("min_longitude"s).AsDouble()},
+                                                    {stat_request_map.at("max_latitude"s).AsDouble(),
+                                                     stat_request_map.at("max_longitude"s).AsDouble()});
+    json::Array stops;
+    stops.reserve(stops_in_box.size());
+    for (const auto* stop : stops_in_box) {
+        stops.emplace_back(std::string(stop->name));
+    }
+    return json::Builder{}.StartDict()
+                              .Key("request_id"s).Value(stat_request_map.at("id"s).AsInt())
+                              .Key("stops"s).Value(std::move(stops))
+                          .EndDict()
+                          .Build();
+}
+
+json::Node JsonReader::GetSearchRequestResult(const json::Dict& stat_request_map, const RequestHandler& handler) const {
+    const size_t count = stat_request_map.count("count"s)
+                         ? static_cast<size_t>(std::max(0, stat_request_map.at("count"s).AsInt())) : DEFAULT_SEARCH_COUNT;
+    json::Array items;
+    for (const auto& match : handler.SearchNames(stat_request_map.at("query"s).AsString(), count)) {
         items.emplace_back(json::Builder{}.StartDict()
-                                              .Key("type"s).Value("Bus"s)
-                                              .Key("bus"s).Value(std::string(item.bus_name))
-                                              .Key("span_count"s).Value(item.span_count)
-                                              .Key("time"s).Value(item.weight)
+                                              .Key("name"s).Value(std::string(match.name))
+                                              .Key("type"s).Value(match.kind == transport::NameKind::STOP ? "Stop"s : "Bus"s)
+                                              .Key("distance"s).Value(match.distance)
                                           .EndDict()
-                                          .Build());        
+                                          .Build());
     }
     return json::Builder{}.StartDict()
-                              .Key("request_id"s).Value(request_id)
-                              .Key("total_time"s).Value(path_info.total_time)
-                              .Key("items"s).Value(items)
+                              .Key("request_id"s).Value(stat_request_map.at("id"s).AsInt())
+                              .Key("items"s).Value(std::move(items))
                           .EndDict()
-                          .Build();    
+                          .Build();
 }
@@ -16,13 +16,17 @@ public:
 
     void FillRenderer(MapRenderer& renderer) const;
     
-    void FillTransportRouter(transport::TransportRouter& transport_router) const;
+    transport::RoutingSettings ReadRoutingSettings() const;
+
+    void FillTransportRouter(transport::TransportRouterBase& transport_router) const;
     
     void PrintRequestsResults(const RequestHandler& handler, std::ostream& out) const;
     
     const json::Document& GetDocument() const;
 
 private:
+    static constexpr size_t DEFAULT_SEARCH_COUNT = 10;
+    
     void FillCatalogueWithStops(const json::Array& base_requests, 
                                 transport::TransportCatalogue& catalogue) const;
     void FillCatalogueWithDistances(const json::Array& base_requests, 
@@ -32,6 +36,14 @@ private:
         
     svg::Color ReadColorFromJson(json::Node color) const;
     std::vector<svg::Color> ReadArrayColorFromJson(std::vector<json::Node> colors) const;
+    int ReadBusWaitTimeFromJson(const json::Dict& routing_settings_map) const;
+    size_t ReadPathCacheCapacityFromJson(const json::Dict& routing_settings_map) const;
+    size_t ReadLandmarkCountFromJson(const json::Dict& routing_settings_map) const;
+    transport::RouterMode ReadRouterModeFromJson(const json::Dict& routing_settings_map) const;
+    transport::GraphModel ReadGraphModelFromJson(const json::Dict& routing_settings_map) const;
+    transport::VertexOrder ReadVertexOrderFromJson(const json::Dict& routing_settings_map) const;
+    transport::WeightType ReadWeightTypeFromJson(const json::Dict& routing_settings_map) const;
+    std::vector<double> ReadDepartureTimesFromJson(const json::Dict& bus_request_map) const;
     
     json::Node GetRouteRequestResult(std::string_view bus_name, int request_id, 
                                      const RequestHandler& handler) const;
@@ -39,8 +51,23 @@ private:
                                     const RequestHandler& handler) const;
     json::Node GetMapRequestResult(int request_id, const RequestHandler& handler) const;
     
-    json::Node GetPathRequestResult(std::string_view stop_from, std::string_view stop_to, 
-                                    int request_id, const RequestHandler& handler) const;
+    json::Node GetPathRequestResult(std::string_view stop_from, std::string_view stop_to, double departure_time,
+                                    int request_id, const RequestHandler& handler, transport::PathInfo& path_info) const;
+    
+    json::Node GetParetoPathsRequestResult(std::string_view stop_from, std::string_view stop_to, double departure_time,
+                                           int request_id, const RequestHandler& handler) const;
+    json::Array GetPathItems(const transport::PathInfo& path_info) const;
+    
+    json::Node GetIsochroneRequestResult(const json::Dict& stat_request_map, const RequestHandler& handler) const;
+    
+    json::Node GetNearbyRequestResult(const json::Dict& stat_request_map, const RequestHandler& handler) const;
+    
+    json::Node GetStopsInBoxRequestResult(const json::Dict& stat_request_map, const RequestHandler& handler) const;
+    
+    json::Node GetSearchRequestResult(const json::Dict& stat_request_map, const RequestHandler& handler) const;
+    
+    json::Node GetMatrixRequestResult(const json::Array& stops_from, const json::Array& stops_to, double departure_time,
+                                      int request_id, const RequestHandler& handler) const;
     
     json::Document requests_doc_;
 };
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cstdlib>
+#include <functional>
+#include <list>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+#include <utility>
+
+namespace cache {
+
+struct CacheStats {
+    size_t hits = 0;
+    size_t misses = 0;
+    size_t evictions = 0;
+};
+
+// Bounded map that evicts the least recently used entry. All methods are thread-safe,
+// values are copied in and out under the lock. Zero capacity disables the cache.
+template <typename Key, typename Value, typename Hasher = std::hash<Key>>
+class LruCache {
+public:
+    explicit LruCache(size_t capacity = 0)
+        : capacity_(capacity) {
+    }
+
+    std::optional<Value> Get(const Key& key) {
+        std::lock_guard lock(mutex_);
+        const auto it = entry_by_key_.find(key);
+        if (it == entry_by_key_.end()) {
+            ++stats_.misses;
+            return std::nullopt;
+        }
+        ++stats_.hits;
+        entries_.splice(entries_.begin(), entries_, it->second);
+        return it->second->second;
+    }
+
+    void Put(const Key& key, Value value) {
+        std::lock_guard lock(mutex_);
+        if (capacity_ == 0) {
+            return;
+        }
+        if (const auto it = entry_by_key_.find(key); it != entry_by_key_.end()) {
+            it->second->second = std::move(value);
+            entries_.splice(entries_.begin(), entries_, it->second);
+            return;
+        }
+        if (entries_.size() == capacity_) {
+            entry_by_key_.erase(entries_.back().first);
+            entries_.pop_back();
+            ++stats_.evictions;
+        }
+        entries_.emplace_front(key, std::move(value));
+        entry_by_key_[key] = entries_.begin();
+    }
+
+    // Drops all entries and resets the counters, the capacity may be changed at the same time.
+    void Reset(size_t capacity) {
+        std::lock_guard lock(mutex_);
+        capacity_ = capacity;
+        entries_.clear();
+        entry_by_key_.clear();
+        stats_ = {};
+    }
+
+    CacheStats GetStats() const {
+        std::lock_guard lock(mutex_);
+        return stats_;
+    }
+
+private:
+    using Entries = std::list<std::pair<Key, Value>>;
+
+    size_t capacity_;
+    Entries entries_;
+    std::unordered_map<Key, typename Entries::iterator, Hasher> entry_by_key_;
+    CacheStats stats_;
+    mutable std::mutex mutex_;
+};
+
+} // namespace cache
@@ -9,15 +9,14 @@
 int main () {
     transport::TransportCatalogue ctlg;
     MapRenderer renderer;
-    transport::TransportRouter router;
     
     JsonReader reader(std::cin);
     
     reader.FillCatalogue(ctlg);
     reader.FillRenderer(renderer);
-    reader.FillTransportRouter(router);
+    const auto router = transport::MakeTransportRouter(reader.ReadRoutingSettings());
     
-    RequestHandler handler(ctlg, renderer, router);
+    RequestHandler handler(ctlg, renderer, *router);
     
     handler.UpdateTransportRouterData();
     
@@ -4,6 +4,30 @@ bool IsZero(double value) {
     return std::abs(value) < EPSILON;
 }
 
+namespace {
+
+// Stop ids are dense, so the stops can be looked up by id in a vector.
+std::vector<const transport::Stop*> GetStopsById(const std::unordered_map<std::string_view, const transport::Stop*>& all_stops) {
+    std::vector<const transport::Stop*> stops_by_id(all_stops.size());
+    for (const auto [stop_name, stop_info] : all_stops) {
+        stops_by_id[stop_info->id] = stop_info;
+    }
+    return stops_by_id;
+}
+
+std::vector<bool> FindStopsInRoutes(size_t stop_count,
+                                    const std::unordered_map<std::string_view, const transport::Route*>& all_routes) {
+    std::vector<bool> is_stop_in_routes(stop_count, false);
+    for (const auto [route_name, route_info] : all_routes) {
+        for (const transport::StopId stop_id : route_info->stops) {
+            is_stop_in_routes[stop_id] = true;
+        }
+    }
+    return is_stop_in_routes;
+}
+
+} // namespace
+
 svg::Point SphereProjector::operator()(geo::Coordinates coords) const {
     return {(coords.lng - min_lon_) * zoom_coeff_ + padding_,
             (max_lat_ - coords.lat) * zoom_coeff_ + padding_};
@@ -120,20 +144,67 @@ void MapRenderer::AddAllStopsTexts(const std::map<std::string_view, svg::Point>&
 
 svg::Document MapRenderer::MakeSvgDocument(const std::unordered_map<std::string_view, const transport::Stop*>& all_stops,
                                            const std::unordered_map<std::string_view, const transport::Route*>& all_routes) const {
-    std::vector<geo::Coordinates> coords_of_all_stops_in_routs;
+    const SphereProjector proj_ = MakeProjector(all_stops, all_routes);
+    const auto route_render_info_by_route_name = MakeRoutesRenderInfo(all_stops, all_routes, proj_);
+    
+    std::map<std::string_view, svg::Point> coords_of_stop_in_route_by_stop_name;
+    const std::vector<bool> is_stop_in_routes = FindStopsInRoutes(all_stops.size(), all_routes);
     for (const auto [stop_name, stop_info] : all_stops) {
-        for (const auto [route_name, route_info] : all_routes) {
-            if (std::count(route_info->stops.begin(), route_info->stops.end(), stop_name)) {
-                coords_of_all_stops_in_routs.push_back(stop_info->coordinates);
-                break;
-            }
-        }    
+        if (is_stop_in_routes[stop_info->id]) {
+            coords_of_stop_in_route_by_stop_name[stop_name] = proj_(stop_info->coordinates);
+        }
     }
-    const SphereProjector proj_{coords_of_all_stops_in_routs.begin(), 
-                                coords_of_all_stops_in_routs.end(), settings_.width, settings_.height, settings_.padding};
-    
+            
+    svg::Document all_objects;
+    MapRenderer::AddAllRoutesLines(route_render_info_by_route_name, all_objects);
+    MapRenderer::AddAllRoutesTexts(route_render_info_by_route_name, all_objects);
+    MapRenderer::AddAllStopsPoints(coords_of_stop_in_route_by_stop_name, all_objects);
+    MapRenderer::AddAllStopsTexts(coords_of_stop_in_route_by_stop_name, all_objects);
+    return all_objects;
+}
+
+svg::Document MapRenderer::MakeIsochroneSvgDocument(const std::unordered_map<std::string_view, const transport::Stop*>& all_stops,
+                                                    const std::unordered_map<std::string_view, const transport::Route*>& all_routes,
+                                                    const std::vector<std::pair<std::string_view, double>>& stop_times,
+                                                    double max_time) const {
+    const SphereProjector proj_ = MakeProjector(all_stops, all_routes);
+    svg::Document all_objects;
+    MapRenderer::AddAllRoutesLines(MakeRoutesRenderInfo(all_stops, all_routes, proj_), all_objects);
     
+    std::map<std::string_view, svg::Point> coords_of_reached_stop_by_stop_name;
+    const size_t number_of_colors = settings_.color_palette.size();
+    for (const auto& [stop_name, time] : stop_times) {
+        const svg::Point stop_coords = proj_(all_stops.at(stop_name)->coordinates);
+        coords_of_reached_stop_by_stop_name[stop_name] = stop_coords;
+        svg::Color fill_color = std::string("white");
+        if (number_of_colors > 0) {
+            const size_t color_index = max_time > 0.0 ? static_cast<size_t>(time / max_time * number_of_colors) : 0;
+            fill_color = settings_.color_palette[std::min(color_index, number_of_colors - 1)];
+        }
+        all_objects.Add(svg::Circle().SetCenter(stop_coords).SetRadius(settings_.stop_radius).SetFillColor(fill_color));
+    }
+    MapRenderer::AddAllStopsTexts(coords_of_reached_stop_by_stop_name, all_objects);
+    return all_objects;
+}
+
+SphereProjector MapRenderer::MakeProjector(const std::unordered_map<std::string_view, const transport::Stop*>& all_stops,
+                                           const std::unordered_map<std::string_view, const transport::Route*>& all_routes) const {
+    std::vector<geo::Coordinates> coords_of_all_stops_in_routs;
+    const std::vector<bool> is_stop_in_routes = FindStopsInRoutes(all_stops.size(), all_routes);
+    for (const auto [stop_name, stop_info] : all_stops) {
+        if (is_stop_in_routes[stop_info->id]) {
+            coords_of_all_stops_in_routs.push_back(stop_info->coordinates);
+        }
+    }
+    return {coords_of_all_stops_in_routs.begin(), 
+            coords_of_all_stops_in_routs.end(), settings_.width, settings_.height, settings_.padding};
+}
+
+std::map<std::string_view, InfoForRenderRoute> MapRenderer::MakeRoutesRenderInfo(
+    const std::unordered_map<std::string_view, const transport::Stop*>& all_stops,
+    const std::unordered_map<std::string_view, const transport::Route*>& all_routes, const SphereProjector& proj_) const {
     std::map<std::string_view, InfoForRenderRoute> route_render_info_by_route_name;
+    const std::vector<const transport::Stop*> stops_by_id = GetStopsById(all_stops);
     for (const auto [route_name, route_info] : all_routes) {
         std::vector<svg::Point> all_stops_coords_in_route;
         if (!route_info->is_roundtrip) {
@@ -141,8 +212,8 @@ svg::Document MapRenderer::MakeSvgDocument(const std::unordered_map<std::string_
         } else {
             all_stops_coords_in_route.reserve(route_info->stops.size());
         }    
-        for (const auto& stop_name : route_info->stops) {
-            all_stops_coords_in_route.push_back(proj_(all_stops.at(stop_name)->coordinates));    
+        for (const transport::StopId stop_id : route_info->stops) {
+            all_stops_coords_in_route.push_back(proj_(stops_by_id[stop_id]->coordinates));    
         }
         if (!route_info->is_roundtrip) {
             all_stops_coords_in_route.insert(all_stops_coords_in_route.end(), 
@@ -150,21 +221,5 @@ svg::Document MapRenderer::MakeSvgDocument(const std::unordered_map<std::string_
         }       
         route_render_info_by_route_name[route_name] = {all_stops_coords_in_route, route_info->is_roundtrip};
     }
-    
-    std::map<std::string_view, svg::Point> coords_of_stop_in_route_by_stop_name;
-    for (const auto [stop_name, stop_info] : all_stops) {
-        for (const auto [route_name, route_info] : all_routes) {
-            if (std::count(route_info->stops.begin(), route_info->stops.end(), stop_name)) {
-                coords_of_stop_in_route_by_stop_name[stop_name] = proj_(stop_info->coordinates);
-                break;
-            }
-        }
-    }
-            
-    svg::Document all_objects;
-    MapRenderer::AddAllRoutesLines(route_render_info_by_route_name, all_objects);
-    MapRenderer::AddAllRoutesTexts(route_render_info_by_route_name, all_objects);
-    MapRenderer::AddAllStopsPoints(coords_of_stop_in_route_by_stop_name, all_objects);
-    MapRenderer::AddAllStopsTexts(coords_of_stop_in_route_by_stop_name, all_objects);
-    return all_objects;
+    return route_render_info_by_route_name;
 }
@@ -111,6 +111,20 @@ public:
     svg::Document MakeSvgDocument(const std::unordered_map<std::string_view, const transport::Stop*>& all_stops,
                                   const std::unordered_map<std::string_view, const transport::Route*>& all_routes) const;
     
+    // The routes map with only the given stops, a stop is filled with the palette color of
+    // its time: the palette is spread evenly over [0, max_time].
+    svg::Document MakeIsochroneSvgDocument(const std::unordered_map<std::string_view, const transport::Stop*>& all_stops,
+                                           const std::unordered_map<std::string_view, const transport::Route*>& all_routes,
+                                           const std::vector<std::pair<std::string_view, double>>& stop_times,
+                                           double max_time) const;
+    
 private:    
+    SphereProjector MakeProjector(const std::unordered_map<std::string_view, const transport::Stop*>& all_stops,
+                                  const std::unordered_map<std::string_view, const transport::Route*>& all_routes) const;
+    
+    std::map<std::string_view, InfoForRenderRoute> MakeRoutesRenderInfo(
+        const std::unordered_map<std::string_view, const transport::Stop*>& all_stops,
+        const std::unordered_map<std::string_view, const transport::Route*>& all_routes, const SphereProjector& proj) const;
+    
     RenderSettings settings_;
 };
@@ -0,0 +1,29 @@
+#include "name_arena.h"
+
+#include <algorithm>
+
+namespace transport {
+
+std::string_view NameArena::Store(std::string_view name) {
+    char* const data = Allocate(name.size());
+    std::copy(name.begin(), name.end(), data);
+    return {data, name.size()};
+}
+
+char* NameArena::Allocate(size_t size) {
+    if (size > BLOCK_SIZE) {
+        blocks_.push_back(std::make_unique<char[]>(size));
+        return blocks_.back().get();
+    }
+    if (size > block_free_size_) {
+        blocks_.push_back(std::make_unique<char[]>(BLOCK_SIZE));
+        block_free_ = blocks_.back().get();
+        block_free_size_ = BLOCK_SIZE;
+    }
+    char* const data = block_free_;
+    block_free_ += size;
+    block_free_size_ -= size;
+    return data;
+}
+
+} // namespace transport
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstdlib>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+namespace transport {
+
+// Append-only storage of names in large blocks. The views returned by Store stay valid
+// for the lifetime of the arena. The arena does not look for equal names itself: the
+// catalogue interns names through its own indexes by name.
+class NameArena {
+public:
+    NameArena() = default;
+    NameArena(const NameArena&) = delete;
+    NameArena& operator=(const NameArena&) = delete;
+    NameArena(NameArena&&) = default;
+    NameArena& operator=(NameArena&&) = default;
+
+    std::string_view Store(std::string_view name);
+
+private:
+    static constexpr size_t BLOCK_SIZE = 64 * 1024;
+
+    // Names longer than a block get a block of their own.
+    char* Allocate(size_t size);
+
+    std::vector<std::unique_ptr<char[]>> blocks_;
+    char* block_free_ = nullptr;
+    size_t block_free_size_ = 0;
+};
+
+} // namespace transport
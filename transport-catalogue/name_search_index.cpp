@@ -0,0 +1,271 @@
+#include "name_search_index.h"
+
+#include <algorithm>
+#include <array>
+#include <bitset>
+#include <limits>
+#include <tuple>
+#include <utility>
+
+namespace transport {
+
+namespace {
+
+bool IsNameLess(const NameSearchIndex::Name& lhs, const NameSearchIndex::Name& rhs) {
+    return std::tie(lhs.name, lhs.kind) < std::tie(rhs.name, rhs.kind);
+}
+
+bool StartsWith(std::string_view name, std::string_view prefix) {
+    return name.substr(0, prefix.size()) == prefix;
+}
+
+size_t CountTrailingZeros(uint64_t word) {
+    return std::bitset<64>((word & (~word + 1)) - 1).count();
+}
+
+// Edit distance between the query and the closest prefix of a name, if at most max_distance.
+// Queries up to 64 bytes take the bit-parallel algorithm of Myers: a column of the table is a
+// word of vertical deltas, so a name byte costs a few word operations. Longer queries fill the
+// band |query length - prefix length| <= max_distance row by row.
+class PrefixDistance {
+public:
+    PrefixDistance(std::string_view query, int max_distance)
+        : query_(query)
+        , max_distance_(max_distance)
+    {
+        if (query_.size() <= WORD_BITS) {
+            for (size_t index = 0; index < query_.size(); ++index) {
+                byte_masks_[static_cast<unsigned char>(query_[index])] |= uint64_t{1} << index;
+            }
+        }
+    }
+
+    std::optional<int> operator()(std::string_view name) {
+        return query_.size() <= WORD_BITS ? ComputeByBits(name) : ComputeByRows(name);
+    }
+
+private:
+    static constexpr size_t WORD_BITS = 64;
+
+    std::optional<int> ComputeByBits(std::string_view name) const {
+        const size_t column_count = std::min(name.size(), query_.size() + max_distance_);
+        const uint64_t last_bit = uint64_t{1} << (query_.size() - 1);
+        uint64_t vertical_positive = ~uint64_t{0};
+        uint64_t vertical_negative = 0;
+        int distance = static_cast<int>(query_.size());
+        int min_distance = distance;
+        for (size_t column = 0; column < column_count; ++column) {
+            const uint64_t equal = byte_masks_[static_cast<unsigned char>(name[column])];
+            const uint64_t vertical = equal | vertical_negative;
+            const uint64_t horizontal = (((equal & vertical_positive) + vertical_positive) ^ vertical_positive) | equal;
+            // The first row of the table is the prefix length, so it always grows by one.
+            uint64_t horizontal_positive = vertical_negative | ~(horizontal | vertical_positive);
+            uint64_t horizontal_negative = vertical_positive & horizontal;
+            if (horizontal_positive & last_bit) {
+                ++distance;
+            } else if (horizontal_negative & last_bit) {
+                --distance;
+            }
+            min_distance = std::min(min_distance, distance);
+            horizontal_positive = (horizontal_positive << 1) | 1;
+            horizontal_negative <<= 1;
+            vertical_positive = horizontal_negative | ~(vertical | horizontal_positive);
+            vertical_negative = horizontal_positive & vertical;
+        }
+        if (min_distance > max_distance_) {
+            return std::nullopt;
+        }
+        return min_distance;
+    }
+
+    std::optional<int> ComputeByRows(std::string_view name) {
+        const int too_far = max_distance_ + 1;
+        const size_t query_size = query_.size();
+        const size_t column_count = std::min(name.size(), query_size + max_distance_) + 1;
+        previous_row_.assign(column_count, too_far);
+        row_.assign(column_count, too_far);
+        for (size_t column = 0; column < column_count && column <= static_cast<size_t>(max_distance_); ++column) {
+            previous_row_[column] = static_cast<int>(column);
+        }
+        for (size_t line = 1; line <= query_size; ++line) {
+            const size_t first_column = line > static_cast<size_t>(max_distance_) ? line - max_distance_ : 0;
+            const size_t last_column = std::min(column_count - 1, line + max_distance_);
+            std::fill(row_.begin(), row_.end(), too_far);
+            int row_min = too_far;
+            for (size_t column = first_column; column <= last_column; ++column) {
+                int distance = previous_row_[column] + 1;
+                if (column == 0) {
+                    distance = std::min(distance, static_cast<int>(line));
+                } else {
+                    distance = std::min({distance, row_[column - 1] + 1,
+                                         previous_row_[column - 1] + (query_[line - 1] != name[column - 1] ? 1 : 0)});
+                }
+                row_[column] = std::min(distance, too_far);
+                row_min = std::min(row_min, row_[column]);
+            }
+            if (row_min == too_far) {
+                return std::nullopt;
+            }
+            std::swap(row_, previous_row_);
+        }
+        const int distance = *std::min_element(previous_row_.begin(), previous_row_.end());
+        if (distance == too_far) {
+            return std::nullopt;
+        }
+        return distance;
+    }
+
+    std::string_view query_;
+    int max_distance_ = 0;
+    std::array<uint64_t, 256> byte_masks_{};
+    // Buffers of the rows, so checking a candidate doesn't allocate.
+    std::vector<int> previous_row_;
+    std::vector<int> row_;
+};
+
+} // namespace
+
+NameSearchIndex::NameSearchIndex(std::vector<Name> names)
+    : names_(std::move(names))
+{
+    std::sort(names_.begin(), names_.end(), IsNameLess);
+    names_.erase(std::unique(names_.begin(), names_.end(), [](const Name& lhs, const Name& rhs) {
+                     return lhs.name == rhs.name && lhs.kind == rhs.kind;
+                 }),
+                 names_.end());
+
+    std::vector<std::tuple<uint32_t, uint32_t, uint32_t>> gram_postings;
+    for (uint32_t name_index = 0; name_index < names_.size(); ++name_index) {
+        const std::vector<uint32_t> grams = GetGrams(names_[name_index].name);
+        for (uint32_t position = 0; position < grams.size(); ++position) {
+            gram_postings.push_back({grams[position], position, name_index});
+        }
+    }
+    std::sort(gram_postings.begin(), gram_postings.end());
+    postings_.reserve(gram_postings.size());
+    for (const auto& [gram, position, name_index] : gram_postings) {
+        if (grams_.empty() || grams_.back() != gram) {
+            grams_.push_back(gram);
+            gram_begins_.push_back(postings_.size());
+        }
+        postings_.push_back({position, name_index});
+    }
+    gram_begins_.push_back(postings_.size());
+}
+
+std::vector<NameMatch> NameSearchIndex::Find(std::string_view query, size_t count) const {
+    std::vector<NameMatch> matches;
+    if (query.empty() || count == 0) {
+        return matches;
+    }
+    FindPrefixMatches(query, count, matches);
+    if (matches.size() < count) {
+        FindTypoMatches(query, count, matches);
+    }
+    return matches;
+}
+
+std::optional<int> NameSearchIndex::MatchName(std::string_view query, std::string_view name) {
+    if (query.empty()) {
+        return std::nullopt;
+    }
+    if (StartsWith(name, query)) {
+        return 0;
+    }
+    const int max_distance = GetMaxDistance(query.size());
+    if (max_distance == 0) {
+        return std::nullopt;
+    }
+    return PrefixDistance(query, max_distance)(name);
+}
+
+std::vector<uint32_t> NameSearchIndex::GetGrams(std::string_view name) {
+    std::vector<uint32_t> grams;
+    grams.reserve(name.size());
+    uint32_t gram = 0;
+    for (const char c : name) {
+        gram = ((gram << 8) | static_cast<unsigned char>(c)) & GRAM_MASK;
+        grams.push_back(gram);
+    }
+    return grams;
+}
+
+// At least one trigram of the query must survive the edits.
+int NameSearchIndex::GetMaxDistance(size_t query_size) {
+    return std::min(MAX_DISTANCE, (static_cast<int>(query_size) - 1) / 3);
+}
+
+void NameSearchIndex::FindPrefixMatches(std::string_view query, size_t count, std::vector<NameMatch>& matches) const {
+    auto it = std::lower_bound(names_.begin(), names_.end(), query, [](const Name& name, std::string_view value) {
+        return name.name < value;
+    });
+    for (; it != names_.end() && matches.size() < count && StartsWith(it->name, query); ++it) {
+        matches.push_back({it->name, it->kind, 0});
+    }
+}
+
+// The exact prefixes are found by FindPrefixMatches, so only names at a positive distance are added.
+void NameSearchIndex::FindTypoMatches(std::string_view query, size_t count, std::vector<NameMatch>& matches) const {
+    const int max_distance = GetMaxDistance(query.size());
+    if (max_distance == 0) {
+        return;
+    }
+    const std::vector<uint32_t> query_grams = GetGrams(query);
+    std::vector<std::pair<uint32_t, uint32_t>> posting_ranges;
+    posting_ranges.reserve(query_grams.size());
+    for (uint32_t position = 0; position < query_grams.size(); ++position) {
+        const auto it = std::lower_bound(grams_.begin(), grams_.end(), query_grams[position]);
+        if (it == grams_.end() || *it != query_grams[position]) {
+            continue;
+        }
+        const auto gram_begin = postings_.begin() + gram_begins_[it - grams_.begin()];
+        const auto gram_end = postings_.begin() + gram_begins_[it - grams_.begin() + 1];
+        const uint32_t min_position = position > static_cast<uint32_t>(max_distance) ? position - max_distance : 0;
+        const uint32_t max_position = position + max_distance;
+        const auto begin = std::lower_bound(gram_begin, gram_end, min_position, [](const Posting& posting, uint32_t value) {
+            return posting.position < value;
+        });
+        const auto end = std::upper_bound(begin, gram_end, max_position, [](uint32_t value, const Posting& posting) {
+            return value < posting.position;
+        });
+        posting_ranges.push_back({begin - postings_.begin(), end - postings_.begin()});
+    }
+    // Every edit breaks at most 3 query trigrams, so a match shares the others with the name.
+    // A bitmap of the names that reach the count both drops the repeats and gives them in the
+    // order of names. Lowering the count for very long queries only adds candidates.
+    const size_t required_count = std::min<size_t>(query_grams.size() - 3 * max_distance,
+                                                   std::numeric_limits<uint8_t>::max());
+    std::vector<uint8_t> gram_counts(names_.size());
+    std::vector<uint64_t> candidate_words((names_.size() + 63) / 64);
+    for (const auto& [begin, end] : posting_ranges) {
+        for (uint32_t posting_index = begin; posting_index < end; ++posting_index) {
+            const uint32_t name_index = postings_[posting_index].name_index;
+            if (gram_counts[name_index] < required_count && ++gram_counts[name_index] == required_count) {
+                candidate_words[name_index / 64] |= uint64_t{1} << (name_index % 64);
+            }
+        }
+    }
+
+    // After enough matches at distance 1 the later names can't be among the first.
+    const size_t needed_count = count - matches.size();
+    size_t nearest_count = 0;
+    std::vector<std::pair<int, uint32_t>> typo_matches;
+    PrefixDistance compute_distance(query, max_distance);
+    for (size_t word_index = 0; word_index < candidate_words.size() && nearest_count < needed_count; ++word_index) {
+        for (uint64_t word = candidate_words[word_index]; word != 0 && nearest_count < needed_count; word &= word - 1) {
+            const uint32_t name_index = static_cast<uint32_t>(word_index * 64 + CountTrailingZeros(word));
+            const auto distance = compute_distance(names_[name_index].name);
+            if (distance && *distance > 0) {
+                typo_matches.push_back({*distance, name_index});
+                nearest_count += *distance == 1 ? 1 : 0;
+            }
+        }
+    }
+    std::sort(typo_matches.begin(), typo_matches.end());
+    for (size_t index = 0; index < typo_matches.size() && matches.size() < count; ++index) {
+        const Name& name = names_[typo_matches[index].second];
+        matches.push_back({name.name, name.kind, typo_matches[index].first});
+    }
+}
+
+} // namespace transport
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdlib>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+namespace transport {
+
+enum class NameKind {
+    STOP,
+    ROUTE,
+};
+
+struct NameMatch {
+    std::string_view name;
+    NameKind kind = NameKind::STOP;
+    // Edits between the query and the closest prefix of the name, in bytes.
+    int distance = 0;
+};
+
+// Search of the names that start with the query, allowing typos. Exact prefixes come from
+// the sorted array of names. An edit breaks at most 3 of the trigrams of the query and shifts
+// the others by at most one byte, so a prefix with up to d edits shares all but 3d query
+// trigrams within d bytes of their places in the query. Only the names with enough such
+// trigrams get the edit distance checked. Names are compared bytewise.
+class NameSearchIndex {
+public:
+    struct Name {
+        std::string_view name;
+        NameKind kind = NameKind::STOP;
+    };
+
+    NameSearchIndex() = default;
+    // The views must outlive the index.
+    explicit NameSearchIndex(std::vector<Name> names);
+
+    // Up to count matches ordered by distance, name and kind.
+    std::vector<NameMatch> Find(std::string_view query, size_t count) const;
+
+    // The distance for a name that matches the query, so names outside the index are ranked
+    // the same way. A query of 4 bytes allows one typo, of 7 or more two.
+    static std::optional<int> MatchName(std::string_view query, std::string_view name);
+
+private:
+    static constexpr int MAX_DISTANCE = 2;
+    static constexpr uint32_t GRAM_MASK = 0xFFFFFF;
+
+    struct Posting {
+        uint32_t position = 0;
+        uint32_t name_index = 0;
+    };
+
+    // The trigram ending at every byte of the name, padded with two zero bytes in front.
+    static std::vector<uint32_t> GetGrams(std::string_view name);
+    static int GetMaxDistance(size_t query_size);
+
+    void FindPrefixMatches(std::string_view query, size_t count, std::vector<NameMatch>& matches) const;
+    void FindTypoMatches(std::string_view query, size_t count, std::vector<NameMatch>& matches) const;
+
+    // Sorted by name and kind, the postings refer to names_. The postings of grams_[i] are
+    // [gram_begins_[i], gram_begins_[i + 1]) of postings_, sorted by position.
+    std::vector<Name> names_;
+    std::vector<uint32_t> grams_;
+    std::vector<uint32_t> gram_begins_;
+    std::vector<Posting> postings_;
+};
+
+} // namespace transport
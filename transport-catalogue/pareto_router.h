@@ -0,0 +1,202 @@
+#pragma once
+
+#include "graph.h"
+#include "static_graph.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <stdexcept>
+#include <tuple>
+#include <vector>
+
+namespace graph {
+
+// Multi-criteria label-setting search for the Pareto set of routes by weight and by an
+// integer count added by the edges, such as the number of rides. Labels are taken in
+// (weight, count) order, so a label at a vertex is dominated exactly when an earlier
+// taken label there has a count not greater than its own: the bag of a vertex reduces to
+// the smallest taken count. All labels of a search are kept in one pool and refer to
+// their previous labels by index. The pool, the counts and the heap live in a workspace
+// of the calling thread, like the SearchWorkspace of the single-criterion searches.
+template <typename Weight>
+class ParetoRouter {
+public:
+    struct RouteInfo {
+        Weight weight;
+        uint32_t count;
+        std::vector<EdgeId> edges;
+    };
+
+    // The graph must outlive the router.
+    explicit ParetoRouter(const StaticGraph<Weight>& graph);
+
+    // edge_count(edge_id) is the count added by the edge. The routes go by weight
+    // ascending and by count descending, none of them is dominated by another one.
+    template <typename EdgeCount>
+    std::vector<RouteInfo> BuildRoutes(VertexId from, VertexId to, const EdgeCount& edge_count) const;
+
+private:
+    using LabelIndex = uint32_t;
+
+    struct Label {
+        Weight weight;
+        uint32_t count;
+        VertexId vertex;
+        LabelIndex prev_label;
+        EdgeId prev_edge;
+    };
+    using QueueItem = std::tuple<Weight, uint32_t, LabelIndex>;
+
+    static constexpr Weight ZERO_WEIGHT{};
+    static constexpr LabelIndex NO_LABEL = std::numeric_limits<LabelIndex>::max();
+    static constexpr uint32_t NO_COUNT = std::numeric_limits<uint32_t>::max();
+
+    // Kept between searches, so a search on a warmed-up thread allocates only its result.
+    // A smallest taken count is valid only if its stamp equals the current generation.
+    class Workspace {
+    public:
+        static Workspace& Acquire(size_t vertex_count);
+
+        uint32_t GetMinTakenCount(VertexId vertex) const {
+            return count_stamps_[vertex] == generation_ ? min_taken_counts_[vertex] : NO_COUNT;
+        }
+
+        void SetMinTakenCount(VertexId vertex, uint32_t count) {
+            count_stamps_[vertex] = generation_;
+            min_taken_counts_[vertex] = count;
+        }
+
+        // A min-heap by (weight, count, label).
+        bool IsQueueEmpty() const {
+            return heap_.empty();
+        }
+
+        void PushQueue(const QueueItem& item) {
+            heap_.push_back(item);
+            std::push_heap(heap_.begin(), heap_.end(), std::greater<QueueItem>());
+        }
+
+        QueueItem PopQueue() {
+            std::pop_heap(heap_.begin(), heap_.end(), std::greater<QueueItem>());
+            const QueueItem item = heap_.back();
+            heap_.pop_back();
+            return item;
+        }
+
+        // Both empty at the start of a search.
+        std::vector<Label>& GetLabels() {
+            return labels_;
+        }
+
+        std::vector<LabelIndex>& GetTargetLabels() {
+            return target_labels_;
+        }
+
+    private:
+        void Prepare(size_t vertex_count);
+
+        std::vector<uint32_t> min_taken_counts_;
+        std::vector<uint32_t> count_stamps_;
+        std::vector<QueueItem> heap_;
+        std::vector<Label> labels_;
+        std::vector<LabelIndex> target_labels_;
+        uint32_t generation_ = 0;
+    };
+
+    const StaticGraph<Weight>& graph_;
+};
+
+template <typename Weight>
+ParetoRouter<Weight>::ParetoRouter(const StaticGraph<Weight>& graph)
+    : graph_(graph)
+{
+    for (VertexId vertex = 0; vertex < graph_.GetVertexCount(); ++vertex) {
+        for (const auto& edge : graph_.GetIncidentEdges(vertex)) {
+            if (edge.weight < ZERO_WEIGHT) {
+                throw std::domain_error("Edges' weights should be non-negative");
+            }
+        }
+    }
+}
+
+template <typename Weight>
+template <typename EdgeCount>
+std::vector<typename ParetoRouter<Weight>::RouteInfo> ParetoRouter<Weight>::BuildRoutes(VertexId from, VertexId to,
+                                                                                       const EdgeCount& edge_count) const {
+    const size_t vertex_count = graph_.GetVertexCount();
+    if (from >= vertex_count || to >= vertex_count) {
+        throw std::out_of_range("Vertex id is out of range");
+    }
+    Workspace& workspace = Workspace::Acquire(vertex_count);
+    std::vector<Label>& labels = workspace.GetLabels();
+    std::vector<LabelIndex>& target_labels = workspace.GetTargetLabels();
+    labels.push_back({ZERO_WEIGHT, 0, from, NO_LABEL, 0});
+    workspace.PushQueue({ZERO_WEIGHT, 0, 0});
+
+    while (!workspace.IsQueueEmpty()) {
+        const auto [weight, count, label_index] = workspace.PopQueue();
+        const VertexId vertex = labels[label_index].vertex;
+        // Both checks are needed: the target's count bounds the counts worth extending anywhere.
+        if (count >= workspace.GetMinTakenCount(vertex) || count >= workspace.GetMinTakenCount(to)) {
+            continue;
+        }
+        workspace.SetMinTakenCount(vertex, count);
+        if (vertex == to) {
+            target_labels.push_back(label_index);
+            if (count == 0) {
+                break;
+            }
+            continue;
+        }
+        for (const auto& edge : graph_.GetIncidentEdges(vertex)) {
+            const uint32_t candidate_count = count + static_cast<uint32_t>(edge_count(edge.edge_id));
+            if (candidate_count >= workspace.GetMinTakenCount(edge.to) || candidate_count >= workspace.GetMinTakenCount(to)) {
+                continue;
+            }
+            const Weight candidate_weight = weight + edge.weight;
+            labels.push_back({candidate_weight, candidate_count, edge.to, label_index, edge.edge_id});
+            workspace.PushQueue({candidate_weight, candidate_count, static_cast<LabelIndex>(labels.size() - 1)});
+        }
+    }
+
+    std::vector<RouteInfo> routes;
+    routes.reserve(target_labels.size());
+    for (const LabelIndex target_label : target_labels) {
+        std::vector<EdgeId> edges;
+        for (LabelIndex label_index = target_label; labels[label_index].prev_label != NO_LABEL;
+             label_index = labels[label_index].prev_label) {
+            edges.push_back(labels[label_index].prev_edge);
+        }
+        std::reverse(edges.begin(), edges.end());
+        routes.push_back({labels[target_label].weight, labels[target_label].count, std::move(edges)});
+    }
+    return routes;
+}
+
+template <typename Weight>
+typename ParetoRouter<Weight>::Workspace& ParetoRouter<Weight>::Workspace::Acquire(size_t vertex_count) {
+    thread_local Workspace workspace;
+    workspace.Prepare(vertex_count);
+    return workspace;
+}
+
+// The stamps are cleared only when the generation counter wraps around.
+template <typename Weight>
+void ParetoRouter<Weight>::Workspace::Prepare(size_t vertex_count) {
+    if (min_taken_counts_.size() < vertex_count) {
+        min_taken_counts_.resize(vertex_count);
+        count_stamps_.resize(vertex_count, 0);
+    }
+    heap_.clear();
+    labels_.clear();
+    target_labels_.clear();
+    ++generation_;
+    if (generation_ == 0) {
+        std::fill(count_stamps_.begin(), count_stamps_.end(), 0);
+        generation_ = 1;
+    }
+}
+
+}  // namespace graph
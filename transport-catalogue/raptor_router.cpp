@@ -0,0 +1,251 @@
+#include "raptor_router.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+using namespace std::literals;
+
+namespace transport {
+
+RaptorRouter::RaptorRouter(const TransportCatalogue& ctlg, double bus_velocity, int bus_wait_time)
+    : bus_wait_time_(bus_wait_time)
+{
+    // Stop indices are the catalogue stop ids.
+    stop_names_.resize(ctlg.GetAllStops().size());
+    for (const auto [stop_name, stop_ptr] : ctlg.GetAllStops()) {
+        stop_index_by_name_[stop_ptr->name] = stop_ptr->id;
+        stop_names_[stop_ptr->id] = stop_ptr->name;
+    }
+    for (const auto [route_name, route_ptr] : ctlg.GetAllRoutes()) {
+        const uint32_t bus_id = bus_names_.size();
+        bus_names_.push_back(route_ptr->name);
+        const double trip_time = AddPattern(ctlg, route_ptr->stops, route_ptr->departure_times, bus_id, bus_velocity);
+        if (!route_ptr->is_roundtrip) {
+            // The bus turns back at the last stop, so its return trips start when the forward ones end.
+            std::vector<double> return_trip_starts = route_ptr->departure_times;
+            for (double& trip_start : return_trip_starts) {
+                trip_start += trip_time;
+            }
+            const std::vector<StopId> return_stops(route_ptr->stops.rbegin(), route_ptr->stops.rend());
+            AddPattern(ctlg, return_stops, std::move(return_trip_starts), bus_id, bus_velocity);
+        }
+    }
+
+    // Counting sort of the (pattern, position) pairs by stop.
+    stop_patterns_begins_.assign(stop_names_.size() + 1, 0);
+    for (const StopIndex stop : pattern_stops_) {
+        ++stop_patterns_begins_[stop + 1];
+    }
+    for (size_t stop = 0; stop < stop_names_.size(); ++stop) {
+        stop_patterns_begins_[stop + 1] += stop_patterns_begins_[stop];
+    }
+    stop_patterns_.resize(pattern_stops_.size());
+    std::vector<uint32_t> next_slots(stop_patterns_begins_.begin(), stop_patterns_begins_.end() - 1);
+    for (PatternIndex pattern_index = 0; pattern_index < patterns_.size(); ++pattern_index) {
+        const Pattern& pattern = patterns_[pattern_index];
+        for (uint32_t position = 0; position < pattern.stop_count; ++position) {
+            const StopIndex stop = pattern_stops_[pattern.stops_begin + position];
+            stop_patterns_[next_slots[stop]++] = {pattern_index, position};
+        }
+    }
+}
+
+bool RaptorRouter::HasStop(std::string_view stop_name) const {
+    return stop_index_by_name_.count(stop_name) > 0;
+}
+
+std::optional<RaptorRouter::Journey> RaptorRouter::BuildJourney(std::string_view stop_from, std::string_view stop_to,
+                                                                double departure_time) const {
+    const StopIndex source = GetStopIndex(stop_from);
+    const StopIndex target = GetStopIndex(stop_to);
+    const Rounds rounds = RunRounds(source, departure_time, target);
+    const double arrival_time = rounds.arrival_times.back()[target];
+    if (arrival_time == UNREACHED) {
+        return std::nullopt;
+    }
+
+    size_t round = 0;
+    while (rounds.arrival_times[round][target] != arrival_time) {
+        ++round;
+    }
+    return ReconstructJourney(rounds, source, target, round);
+}
+
+std::vector<RaptorRouter::Journey> RaptorRouter::BuildJourneys(std::string_view stop_from, std::string_view stop_to,
+                                                               double departure_time) const {
+    const StopIndex source = GetStopIndex(stop_from);
+    const StopIndex target = GetStopIndex(stop_to);
+    const Rounds rounds = RunRounds(source, departure_time, target);
+    std::vector<Journey> journeys;
+    for (size_t round = 0; round < rounds.arrival_times.size(); ++round) {
+        const double arrival_time = rounds.arrival_times[round][target];
+        if (arrival_time != UNREACHED && (round == 0 || arrival_time < rounds.arrival_times[round - 1][target])) {
+            journeys.push_back(ReconstructJourney(rounds, source, target, round));
+        }
+    }
+    return journeys;
+}
+
+// Walks back from the target through the rides that improved the arrivals. A stop not
+// improved in a round was reached in an earlier one.
+RaptorRouter::Journey RaptorRouter::ReconstructJourney(const Rounds& rounds, StopIndex source, StopIndex target,
+                                                       size_t round) const {
+    Journey journey{rounds.arrival_times[round][target], {}};
+    for (StopIndex stop = target; stop != source || round > 0; --round) {
+        if (!rounds.rides[round][stop]) {
+            continue;
+        }
+        const Ride& ride = *rounds.rides[round][stop];
+        const Pattern& pattern = patterns_[ride.pattern];
+        const StopIndex board_stop = pattern_stops_[pattern.stops_begin + ride.board_position];
+        const double board_time = ride.trip_start + ride_times_[pattern.stops_begin + ride.board_position];
+        journey.legs.push_back({bus_names_[pattern.bus_id],
+                                stop_names_[board_stop],
+                                stop_names_[stop],
+                                static_cast<int>(ride.alight_position - ride.board_position),
+                                board_time - rounds.arrival_times[round - 1][board_stop],
+                                ride_times_[pattern.stops_begin + ride.alight_position]
+                                    - ride_times_[pattern.stops_begin + ride.board_position]});
+        stop = board_stop;
+    }
+    std::reverse(journey.legs.begin(), journey.legs.end());
+    return journey;
+}
+
+std::vector<std::optional<double>> RaptorRouter::ComputeArrivalTimes(std::string_view stop_from,
+                                                                     const std::vector<std::string_view>& stops_to,
+                                                                     double departure_time) const {
+    const Rounds rounds = RunRounds(GetStopIndex(stop_from), departure_time, std::nullopt);
+    std::vector<std::optional<double>> arrival_times;
+    arrival_times.reserve(stops_to.size());
+    for (const std::string_view stop_to : stops_to) {
+        const double arrival_time = rounds.arrival_times.back()[GetStopIndex(stop_to)];
+        arrival_times.push_back(arrival_time != UNREACHED ? std::optional<double>(arrival_time) : std::nullopt);
+    }
+    return arrival_times;
+}
+
+std::vector<std::pair<std::string_view, double>> RaptorRouter::FindReachableStops(std::string_view stop_from, double departure_time,
+                                                                                  double max_travel_time) const {
+    const Rounds rounds = RunRounds(GetStopIndex(stop_from), departure_time, std::nullopt, departure_time + max_travel_time);
+    std::vector<std::pair<std::string_view, double>> reachable_stops;
+    const auto& arrival_times = rounds.arrival_times.back();
+    for (StopIndex stop = 0; stop < stop_names_.size(); ++stop) {
+        if (arrival_times[stop] != UNREACHED) {
+            reachable_stops.push_back({stop_names_[stop], arrival_times[stop]});
+        }
+    }
+    return reachable_stops;
+}
+
+double RaptorRouter::AddPattern(const TransportCatalogue& ctlg, const std::vector<StopId>& stops, std::vector<double> trip_starts,
+                                uint32_t bus_id, double bus_velocity) {
+    const int meters_in_km = 1000;
+    const int seconds_in_min = 60;
+    Pattern pattern{static_cast<uint32_t>(pattern_stops_.size()), static_cast<uint32_t>(stops.size()),
+                    static_cast<uint32_t>(trip_starts_.size()), static_cast<uint32_t>(trip_starts.size()), bus_id};
+    double ride_time = 0.0;
+    for (size_t index = 0; index < stops.size(); ++index) {
+        if (index > 0) {
+            ride_time += (ctlg.GetDistance(stops[index - 1], stops[index]) * seconds_in_min) / (meters_in_km * bus_velocity);
+        }
+        pattern_stops_.push_back(stops[index]);
+        ride_times_.push_back(ride_time);
+    }
+    std::sort(trip_starts.begin(), trip_starts.end());
+    trip_starts_.insert(trip_starts_.end(), trip_starts.begin(), trip_starts.end());
+    patterns_.push_back(pattern);
+    return ride_time;
+}
+
+// Every round scans only the patterns through the stops improved by the previous round,
+// each from the first such stop on. A trip is boarded at the earliest stop and replaced
+// whenever an earlier one can be caught further on. Arrivals no better than the current
+// arrival at the target are dropped.
+RaptorRouter::Rounds RaptorRouter::RunRounds(StopIndex source, double departure_time, std::optional<StopIndex> target,
+                                             double arrival_time_limit) const {
+    static constexpr uint32_t NOT_QUEUED = std::numeric_limits<uint32_t>::max();
+    Rounds rounds;
+    rounds.arrival_times.emplace_back(stop_names_.size(), UNREACHED);
+    rounds.rides.emplace_back(stop_names_.size());
+    rounds.arrival_times[0][source] = departure_time;
+
+    std::vector<StopIndex> marked_stops = {source};
+    std::vector<bool> is_marked(stop_names_.size(), false);
+    std::vector<uint32_t> first_positions(patterns_.size(), NOT_QUEUED);
+    std::vector<PatternIndex> queued_patterns;
+    while (!marked_stops.empty()) {
+        for (const StopIndex stop : marked_stops) {
+            is_marked[stop] = false;
+            for (uint32_t index = stop_patterns_begins_[stop]; index < stop_patterns_begins_[stop + 1]; ++index) {
+                const auto [pattern_index, position] = stop_patterns_[index];
+                if (first_positions[pattern_index] == NOT_QUEUED) {
+                    queued_patterns.push_back(pattern_index);
+                }
+                first_positions[pattern_index] = std::min(first_positions[pattern_index], position);
+            }
+        }
+        marked_stops.clear();
+
+        const std::vector<double>& previous_arrival_times = rounds.arrival_times.back();
+        std::vector<double> arrival_times = previous_arrival_times;
+        std::vector<std::optional<Ride>> rides(stop_names_.size());
+        for (const PatternIndex pattern_index : queued_patterns) {
+            const Pattern& pattern = patterns_[pattern_index];
+            std::optional<double> trip_start;
+            uint32_t board_position = 0;
+            for (uint32_t position = first_positions[pattern_index]; position < pattern.stop_count; ++position) {
+                const StopIndex stop = pattern_stops_[pattern.stops_begin + position];
+                if (trip_start) {
+                    const double arrival_time = *trip_start + ride_times_[pattern.stops_begin + position];
+                    if (arrival_time < arrival_times[stop] && arrival_time <= arrival_time_limit
+                        && (!target || arrival_time < arrival_times[*target])) {
+                        arrival_times[stop] = arrival_time;
+                        rides[stop] = Ride{pattern_index, board_position, position, *trip_start};
+                        if (!is_marked[stop]) {
+                            is_marked[stop] = true;
+                            marked_stops.push_back(stop);
+                        }
+                    }
+                }
+                if (previous_arrival_times[stop] != UNREACHED) {
+                    const auto earlier_trip_start = FindTripStart(pattern, position, previous_arrival_times[stop]);
+                    if (earlier_trip_start && (!trip_start || *earlier_trip_start < *trip_start)) {
+                        trip_start = earlier_trip_start;
+                        board_position = position;
+                    }
+                }
+            }
+            first_positions[pattern_index] = NOT_QUEUED;
+        }
+        queued_patterns.clear();
+        rounds.arrival_times.push_back(std::move(arrival_times));
+        rounds.rides.push_back(std::move(rides));
+    }
+    return rounds;
+}
+
+std::optional<double> RaptorRouter::FindTripStart(const Pattern& pattern, uint32_t position, double time) const {
+    const double ride_time = ride_times_[pattern.stops_begin + position];
+    if (pattern.trip_count == 0) {
+        return time + bus_wait_time_ - ride_time;
+    }
+    const auto trips_begin = trip_starts_.begin() + pattern.trips_begin;
+    const auto trips_end = trips_begin + pattern.trip_count;
+    const auto it = std::lower_bound(trips_begin, trips_end, time - ride_time);
+    if (it == trips_end) {
+        return std::nullopt;
+    }
+    return *it;
+}
+
+RaptorRouter::StopIndex RaptorRouter::GetStopIndex(std::string_view stop_name) const {
+    const auto it = stop_index_by_name_.find(stop_name);
+    if (it == stop_index_by_name_.end()) {
+        throw std::out_of_range("Unknown stop: "s + std::string(stop_name));
+    }
+    return it->second;
+}
+
+} // namespace transport
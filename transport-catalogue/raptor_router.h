@@ -0,0 +1,114 @@
+#pragma once
+
+#include "transport_catalogue.h"
+
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace transport {
+
+// Earliest arrival routing over timetables with RAPTOR (round-based public transit routing).
+// Round k finds the journeys with k rides, so the search needs no graph and ends after as
+// many rounds as the best journey has rides plus one. A bus with departure times runs its
+// trips by the timetable, a bus without them is boarded after bus_wait_time of waiting.
+// Times are in minutes.
+class RaptorRouter {
+public:
+    struct Leg {
+        std::string_view bus_name;
+        std::string_view start_stop;
+        std::string_view finish_stop;
+        int span_count = 0;
+        double wait_time = 0.0;
+        double ride_time = 0.0;
+    };
+
+    struct Journey {
+        double arrival_time = 0.0;
+        std::vector<Leg> legs;
+    };
+
+    RaptorRouter(const TransportCatalogue& ctlg, double bus_velocity, int bus_wait_time);
+
+    bool HasStop(std::string_view stop_name) const;
+    // Among the journeys with the earliest arrival, the one with the fewest rides.
+    std::optional<Journey> BuildJourney(std::string_view stop_from, std::string_view stop_to, double departure_time) const;
+    // The Pareto set by arrival time and number of rides: the earliest journey with each
+    // number of rides that arrives earlier than all journeys with fewer rides.
+    // Goes by the number of rides ascending.
+    std::vector<Journey> BuildJourneys(std::string_view stop_from, std::string_view stop_to, double departure_time) const;
+    // arrival_times[i] is the earliest arrival at stops_to[i], nullopt if it is unreachable.
+    std::vector<std::optional<double>> ComputeArrivalTimes(std::string_view stop_from, const std::vector<std::string_view>& stops_to,
+                                                           double departure_time) const;
+    // Pairs of the stops reachable by departure_time + max_travel_time and the arrival
+    // times, in no particular order.
+    std::vector<std::pair<std::string_view, double>> FindReachableStops(std::string_view stop_from, double departure_time,
+                                                                        double max_travel_time) const;
+
+private:
+    using StopIndex = StopId;
+    using PatternIndex = uint32_t;
+
+    static constexpr double UNREACHED = std::numeric_limits<double>::infinity();
+
+    // A pattern is one direction of a bus. All its trips take the same time between stops,
+    // so a trip is given by its departure from the first stop of the pattern.
+    struct Pattern {
+        uint32_t stops_begin;
+        uint32_t stop_count;
+        uint32_t trips_begin;
+        uint32_t trip_count;  // zero for a bus without a timetable
+        uint32_t bus_id;
+    };
+
+    struct StopPattern {
+        PatternIndex pattern;
+        uint32_t position;
+    };
+
+    struct Ride {
+        PatternIndex pattern;
+        uint32_t board_position;
+        uint32_t alight_position;
+        double trip_start;
+    };
+
+    // arrival_times[k][stop] is the earliest arrival with at most k rides, rides[k][stop] is
+    // set when the k-th round improved it.
+    struct Rounds {
+        std::vector<std::vector<double>> arrival_times;
+        std::vector<std::vector<std::optional<Ride>>> rides;
+    };
+
+    // Returns the time of a trip from the first stop to the last one.
+    double AddPattern(const TransportCatalogue& ctlg, const std::vector<StopId>& stops, std::vector<double> trip_starts,
+                      uint32_t bus_id, double bus_velocity);
+    // Arrivals later than arrival_time_limit are dropped.
+    Rounds RunRounds(StopIndex source, double departure_time, std::optional<StopIndex> target,
+                     double arrival_time_limit = UNREACHED) const;
+    Journey ReconstructJourney(const Rounds& rounds, StopIndex source, StopIndex target, size_t round) const;
+    std::optional<double> FindTripStart(const Pattern& pattern, uint32_t position, double time) const;
+    StopIndex GetStopIndex(std::string_view stop_name) const;
+
+    int bus_wait_time_ = 0;
+    std::vector<std::string_view> stop_names_;
+    std::unordered_map<std::string_view, StopIndex> stop_index_by_name_;
+    std::vector<std::string_view> bus_names_;
+
+    // Flat arrays: the stops and ride times of a pattern are [stops_begin, stops_begin + stop_count)
+    // of pattern_stops_ and ride_times_, its sorted trip starts are in trip_starts_. The patterns
+    // through a stop are [stop_patterns_begins_[stop], stop_patterns_begins_[stop + 1]) of stop_patterns_.
+    std::vector<Pattern> patterns_;
+    std::vector<StopIndex> pattern_stops_;
+    std::vector<double> ride_times_;
+    std::vector<double> trip_starts_;
+    std::vector<uint32_t> stop_patterns_begins_;
+    std::vector<StopPattern> stop_patterns_;
+};
+
+} // namespace transport
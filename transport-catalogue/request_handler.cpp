@@ -22,7 +22,56 @@ void RequestHandler::UpdateTransportRouterData() {
     router_.UploadTransportData(catalogue_);
 }
 
-std::optional<transport::PathInfo> RequestHandler::GetPathBetweenTwoStops(std::string_view stop_from, 
-                                                                          std::string_view stop_to) const {
-    return router_.BuildPath(stop_from, stop_to);
+void RequestHandler::UpdateRouteInTransportRouter(std::string_view route_name) {
+    router_.UpdateRoute(catalogue_, route_name);
+}
+
+void RequestHandler::UpdateDistanceInTransportRouter(std::string_view stop_from, std::string_view stop_to) {
+    router_.UpdateDistance(catalogue_, stop_from, stop_to);
+}
+
+bool RequestHandler::GetPathBetweenTwoStops(std::string_view stop_from, std::string_view stop_to, double departure_time,
+                                            transport::PathInfo& path_info) const {
+    return router_.FillPath(stop_from, stop_to, departure_time, path_info);
+}
+
+std::vector<transport::PathInfo> RequestHandler::GetParetoPathsBetweenTwoStops(std::string_view stop_from,
+                                                                               std::string_view stop_to,
+                                                                               double departure_time) const {
+    return router_.BuildParetoPaths(stop_from, stop_to, departure_time);
+}
+
+std::vector<transport::ReachableStop> RequestHandler::GetReachableStops(std::string_view stop_from, double max_time,
+                                                                       double departure_time) const {
+    return router_.FindReachableStops(stop_from, max_time, departure_time);
+}
+
+svg::Document RequestHandler::RenderReachableStops(const std::vector<transport::ReachableStop>& reachable_stops,
+                                                   double max_time) const {
+    std::vector<std::pair<std::string_view, double>> stop_times;
+    stop_times.reserve(reachable_stops.size());
+    for (const auto& reachable_stop : reachable_stops) {
+        stop_times.push_back({reachable_stop.stop_name, reachable_stop.time});
+    }
+    return renderer_.MakeIsochroneSvgDocument(catalogue_.GetAllStops(), catalogue_.GetAllRoutes(), stop_times, max_time);
+}
+
+std::optional<transport::TimeMatrix> RequestHandler::GetTravelTimeMatrix(const std::vector<std::string_view>& stops_from,
+                                                                         const std::vector<std::string_view>& stops_to,
+                                                                         double departure_time) const {
+    return router_.BuildTimeMatrix(stops_from, stops_to, departure_time);
+}
+
+std::vector<std::pair<const transport::Stop*, double>> RequestHandler::GetNearestStops(const geo::Coordinates& point, size_t count,
+                                                                                       double max_distance) const {
+    return catalogue_.FindNearestStops(point, count, max_distance);
+}
+
+std::vector<const transport::Stop*> RequestHandler::GetStopsInBox(const geo::Coordinates& min_corner,
+                                                                  const geo::Coordinates& max_corner) const {
+    return catalogue_.FindStopsInBox(min_corner, max_corner);
+}
+
+std::vector<transport::NameMatch> RequestHandler::SearchNames(std::string_view query, size_t count) const {
+    return catalogue_.SearchNames(query, count);
 }
@@ -8,7 +8,7 @@
 
 class RequestHandler {
 public:
-    RequestHandler(const transport::TransportCatalogue& catalogue, const MapRenderer& renderer, transport::TransportRouter& router)
+    RequestHandler(const transport::TransportCatalogue& catalogue, const MapRenderer& renderer, transport::TransportRouterBase& router)
         : catalogue_(catalogue), renderer_(renderer), router_(router) {
     }
     
@@ -19,11 +19,37 @@ public:
     svg::Document RenderMap() const;
     
     void UpdateTransportRouterData();
+
+    void UpdateRouteInTransportRouter(std::string_view route_name);
+
+    void UpdateDistanceInTransportRouter(std::string_view stop_from, std::string_view stop_to);
+    
+    // The path is written over path_info, see TransportRouterBase::FillPath. Returns false if
+    // there is no path.
+    bool GetPathBetweenTwoStops(std::string_view stop_from, std::string_view stop_to, double departure_time,
+                                transport::PathInfo& path_info) const;
+    
+    std::vector<transport::PathInfo> GetParetoPathsBetweenTwoStops(std::string_view stop_from, std::string_view stop_to,
+                                                                   double departure_time = 0.0) const;
+    
+    std::vector<transport::ReachableStop> GetReachableStops(std::string_view stop_from, double max_time,
+                                                            double departure_time = 0.0) const;
+    
+    svg::Document RenderReachableStops(const std::vector<transport::ReachableStop>& reachable_stops, double max_time) const;
+    
+    std::optional<transport::TimeMatrix> GetTravelTimeMatrix(const std::vector<std::string_view>& stops_from,
+                                                             const std::vector<std::string_view>& stops_to,
+                                                             double departure_time = 0.0) const;
+    
+    std::vector<std::pair<const transport::Stop*, double>> GetNearestStops(const geo::Coordinates& point, size_t count,
+                                                                           double max_distance) const;
+    
+    std::vector<const transport::Stop*> GetStopsInBox(const geo::Coordinates& min_corner, const geo::Coordinates& max_corner) const;
     
-    std::optional<transport::PathInfo> GetPathBetweenTwoStops(std::string_view stop_from, std::string_view stop_to) const;
+    std::vector<transport::NameMatch> SearchNames(std::string_view query, size_t count) const;
     
 private:
     const transport::TransportCatalogue& catalogue_;
     const MapRenderer& renderer_;
-    transport::TransportRouter& router_;
+    transport::TransportRouterBase& router_;
 };
@@ -1,12 +1,17 @@
 #pragma once
 
 #include "graph.h"
+#include "static_graph.h"
+#include "thread_pool.h"
 
 #include <algorithm>
 #include <cassert>
 #include <cstdint>
+#include <functional>
 #include <iterator>
+#include <limits>
 #include <optional>
+#include <queue>
 #include <stdexcept>
 #include <unordered_map>
 #include <utility>
@@ -15,103 +20,516 @@
 namespace graph {
 
 template <typename Weight>
-class Router {
-private:
-    using Graph = DirectedWeightedGraph<Weight>;
-
+class RouterBase {
 public:
-    explicit Router(const Graph& graph);
-
     struct RouteInfo {
         Weight weight;
         std::vector<EdgeId> edges;
     };
 
-    std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const;
+    // weight_matrix[i][j] is the weight of the route from sources[i] to targets[j].
+    using WeightMatrix = std::vector<std::vector<std::optional<Weight>>>;
+
+    std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const {
+        RouteInfo route_info{Weight{}, {}};
+        if (!FillRoute(from, to, route_info)) {
+            return std::nullopt;
+        }
+        return route_info;
+    }
+
+    // Same as BuildRoute, but the edges are written over route_info.edges, so a caller
+    // that keeps route_info between queries reuses its memory. Returns false if there
+    // is no route, route_info is unspecified then.
+    virtual bool FillRoute(VertexId from, VertexId to, RouteInfo& route_info) const = 0;
 
+    // Weights only, the routes themselves are not built. The rows are computed in parallel,
+    // the default implementation falls back to FillRoute.
+    virtual WeightMatrix BuildWeightMatrix(const std::vector<VertexId>& sources, const std::vector<VertexId>& targets,
+                                           concurrency::ThreadPool& thread_pool) const {
+        WeightMatrix weight_matrix(sources.size(), std::vector<std::optional<Weight>>(targets.size()));
+        thread_pool.ParallelFor(sources.size(), [&](size_t source_index) {
+            RouteInfo route_info{Weight{}, {}};
+            for (size_t target_index = 0; target_index < targets.size(); ++target_index) {
+                if (FillRoute(sources[source_index], targets[target_index], route_info)) {
+                    weight_matrix[source_index][target_index] = route_info.weight;
+                }
+            }
+        });
+        return weight_matrix;
+    }
+
+    // Brings the router in line with the graph after the removed_edges were removed from it
+    // and the added_edges were added, new vertices may come with the added edges. Returns
+    // false if the router can't be updated in place and has to be built again.
+    virtual bool UpdateEdges(const std::vector<EdgeId>& /*removed_edges*/, const std::vector<EdgeId>& /*added_edges*/) {
+        return false;
+    }
+
+    virtual ~RouterBase() = default;
+};
+
+template <typename Weight>
+class Router : public RouterBase<Weight> {
 private:
-    struct RouteInternalData {
-        Weight weight;
-        std::optional<EdgeId> prev_edge;
+    using Graph = DirectedWeightedGraph<Weight>;
+
+public:
+    using RouteInfo = typename RouterBase<Weight>::RouteInfo;
+
+    // Dense V x V table in row-major order. Weights and last edges of the routes are kept
+    // in two parallel arrays, an unreachable cell holds UNREACHABLE_WEIGHT and a cell without
+    // a last edge (the route from a vertex to itself) holds NO_PREV_EDGE.
+    using PrevEdgeId = uint32_t;
+    struct RoutesInternalData {
+        std::vector<Weight> weights;
+        std::vector<PrevEdgeId> prev_edges;
     };
-    using RoutesInternalData = std::vector<std::vector<std::optional<RouteInternalData>>>;
+
+    explicit Router(const Graph& graph, size_t thread_count = concurrency::GetDefaultThreadCount());
+    // Takes a table computed earlier for the same graph, e.g. loaded from a file.
+    Router(const Graph& graph, RoutesInternalData routes_internal_data);
+
+    using WeightMatrix = typename RouterBase<Weight>::WeightMatrix;
+
+    bool FillRoute(VertexId from, VertexId to, RouteInfo& route_info) const override;
+    WeightMatrix BuildWeightMatrix(const std::vector<VertexId>& sources, const std::vector<VertexId>& targets,
+                                   concurrency::ThreadPool& thread_pool) const override;
+    bool UpdateEdges(const std::vector<EdgeId>& removed_edges, const std::vector<EdgeId>& added_edges) override;
+    const RoutesInternalData& GetRoutesInternalData() const;
+
+private:
+
+    size_t GetCellIndex(VertexId vertex_from, VertexId vertex_to) const {
+        return vertex_from * vertex_count_ + vertex_to;
+    }
 
     void InitializeRoutesInternalData(const Graph& graph) {
-        const size_t vertex_count = graph.GetVertexCount();
-        for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
-            routes_internal_data_[vertex][vertex] = RouteInternalData{ZERO_WEIGHT, std::nullopt};
+        if (graph.GetEdgeCount() >= NO_PREV_EDGE) {
+            throw std::length_error("Too many edges for the precomputed router");
+        }
+        for (VertexId vertex = 0; vertex < vertex_count_; ++vertex) {
+            routes_internal_data_.weights[GetCellIndex(vertex, vertex)] = ZERO_WEIGHT;
             for (const EdgeId edge_id : graph.GetIncidentEdges(vertex)) {
                 const auto& edge = graph.GetEdge(edge_id);
                 if (edge.weight < ZERO_WEIGHT) {
                     throw std::domain_error("Edges' weights should be non-negative");
                 }
-                auto& route_internal_data = routes_internal_data_[vertex][edge.to];
-                if (!route_internal_data || route_internal_data->weight > edge.weight) {
-                    route_internal_data = RouteInternalData{edge.weight, edge_id};
+                const size_t cell_index = GetCellIndex(vertex, edge.to);
+                Weight& weight = routes_internal_data_.weights[cell_index];
+                if (weight == UNREACHABLE_WEIGHT || weight > edge.weight) {
+                    weight = edge.weight;
+                    routes_internal_data_.prev_edges[cell_index] = static_cast<PrevEdgeId>(edge_id);
                 }
             }
         }
     }
 
-    void RelaxRoute(VertexId vertex_from, VertexId vertex_to, const RouteInternalData& route_from,
-                    const RouteInternalData& route_to) {
-        auto& route_relaxing = routes_internal_data_[vertex_from][vertex_to];
-        const Weight candidate_weight = route_from.weight + route_to.weight;
-        if (!route_relaxing || candidate_weight < route_relaxing->weight) {
-            route_relaxing = {candidate_weight,
-                              route_to.prev_edge ? route_to.prev_edge : route_from.prev_edge};
+    // Min-plus update of the cells [row_begin, row_end) x [column_begin, column_end) through
+    // every vertex of [through_begin, through_end). The inner loop works on contiguous rows
+    // and has no data-dependent branches for floating point weights, so it is vectorized.
+    void RelaxTile(VertexId row_begin, VertexId row_end, VertexId column_begin, VertexId column_end,
+                   VertexId through_begin, VertexId through_end) {
+        Weight* const weights = routes_internal_data_.weights.data();
+        PrevEdgeId* const prev_edges = routes_internal_data_.prev_edges.data();
+        for (VertexId vertex_through = through_begin; vertex_through < through_end; ++vertex_through) {
+            const Weight* const weights_through = weights + GetCellIndex(vertex_through, 0);
+            const PrevEdgeId* const prev_edges_through = prev_edges + GetCellIndex(vertex_through, 0);
+            for (VertexId vertex_from = row_begin; vertex_from < row_end; ++vertex_from) {
+                const size_t row_from = GetCellIndex(vertex_from, 0);
+                const Weight weight_from = weights[row_from + vertex_through];
+                if (weight_from == UNREACHABLE_WEIGHT) {
+                    continue;
+                }
+                const PrevEdgeId prev_edge_from = prev_edges[row_from + vertex_through];
+                RelaxRow(weights + row_from, prev_edges + row_from, weights_through, prev_edges_through,
+                         weight_from, prev_edge_from, column_begin, column_end);
+            }
         }
     }
 
-    void RelaxRoutesInternalDataThroughVertex(size_t vertex_count, VertexId vertex_through) {
-        for (VertexId vertex_from = 0; vertex_from < vertex_count; ++vertex_from) {
-            if (const auto& route_from = routes_internal_data_[vertex_from][vertex_through]) {
-                for (VertexId vertex_to = 0; vertex_to < vertex_count; ++vertex_to) {
-                    if (const auto& route_to = routes_internal_data_[vertex_through][vertex_to]) {
-                        RelaxRoute(vertex_from, vertex_to, *route_from, *route_to);
+    static void RelaxRow(Weight* weights_relaxing, PrevEdgeId* prev_edges_relaxing,
+                         const Weight* weights_through, const PrevEdgeId* prev_edges_through,
+                         Weight weight_from, PrevEdgeId prev_edge_from, VertexId column_begin, VertexId column_end) {
+        if constexpr (std::numeric_limits<Weight>::has_infinity) {
+            // Infinity absorbs the addition, so unreachable cells need no special care.
+            for (VertexId vertex_to = column_begin; vertex_to < column_end; ++vertex_to) {
+                const Weight candidate_weight = weight_from + weights_through[vertex_to];
+                const bool is_better = candidate_weight < weights_relaxing[vertex_to];
+                const PrevEdgeId prev_edge_through = prev_edges_through[vertex_to];
+                const PrevEdgeId candidate_prev_edge = prev_edge_through != NO_PREV_EDGE ? prev_edge_through : prev_edge_from;
+                weights_relaxing[vertex_to] = is_better ? candidate_weight : weights_relaxing[vertex_to];
+                prev_edges_relaxing[vertex_to] = is_better ? candidate_prev_edge : prev_edges_relaxing[vertex_to];
+            }
+        } else {
+            for (VertexId vertex_to = column_begin; vertex_to < column_end; ++vertex_to) {
+                const Weight weight_to = weights_through[vertex_to];
+                if (weight_to == UNREACHABLE_WEIGHT) {
+                    continue;
+                }
+                const Weight candidate_weight = weight_from + weight_to;
+                if (weights_relaxing[vertex_to] == UNREACHABLE_WEIGHT || candidate_weight < weights_relaxing[vertex_to]) {
+                    weights_relaxing[vertex_to] = candidate_weight;
+                    prev_edges_relaxing[vertex_to] = prev_edges_through[vertex_to] != NO_PREV_EDGE
+                                                     ? prev_edges_through[vertex_to] : prev_edge_from;
+                }
+            }
+        }
+    }
+
+    // Blocked Floyd-Warshall: for every diagonal tile the tile itself is relaxed first, then
+    // the tiles of its row and column, then all the others. Tiles of one phase don't
+    // depend on each other and are relaxed in parallel.
+    void RelaxRoutesInternalData(size_t thread_count) {
+        concurrency::ThreadPool thread_pool(thread_count);
+        const size_t tile_count = (vertex_count_ + TILE_SIZE - 1) / TILE_SIZE;
+        const auto tile_begin = [](size_t tile) {
+            return tile * TILE_SIZE;
+        };
+        const auto tile_end = [this](size_t tile) {
+            return std::min(vertex_count_, (tile + 1) * TILE_SIZE);
+        };
+
+        for (size_t tile_through = 0; tile_through < tile_count; ++tile_through) {
+            const VertexId through_begin = tile_begin(tile_through);
+            const VertexId through_end = tile_end(tile_through);
+            RelaxTile(through_begin, through_end, through_begin, through_end, through_begin, through_end);
+
+            thread_pool.ParallelFor(2 * tile_count, [&](size_t task) {
+                const size_t tile = task / 2;
+                if (tile == tile_through) {
+                    return;
+                }
+                if (task % 2 == 0) {
+                    RelaxTile(through_begin, through_end, tile_begin(tile), tile_end(tile), through_begin, through_end);
+                } else {
+                    RelaxTile(tile_begin(tile), tile_end(tile), through_begin, through_end, through_begin, through_end);
+                }
+            });
+
+            thread_pool.ParallelFor(tile_count, [&](size_t tile_row) {
+                if (tile_row == tile_through) {
+                    return;
+                }
+                for (size_t tile_column = 0; tile_column < tile_count; ++tile_column) {
+                    if (tile_column != tile_through) {
+                        RelaxTile(tile_begin(tile_row), tile_end(tile_row), tile_begin(tile_column), tile_end(tile_column),
+                                  through_begin, through_end);
                     }
                 }
+            });
+        }
+
+        thread_pool.ParallelFor(vertex_count_, [this](size_t vertex_from) {
+            if (HasCycleOfPrevEdges(vertex_from)) {
+                ComputeRowByDijkstra(vertex_from);
+            }
+        });
+    }
+
+    // The weights only go down, so the last edge (u, v) of a route always has
+    // weight(u) + weight(u, v) <= weight(v), and a path of last edges that reaches the
+    // source is a shortest one. With zero-weight cycles in the graph, like the stop and ride
+    // vertices of the wait/ride model without a wait time, the order of the tiles may still
+    // close a cycle of last edges that never reaches the source.
+    bool HasCycleOfPrevEdges(VertexId vertex_from) const {
+        const PrevEdgeId* const prev_edges = routes_internal_data_.prev_edges.data() + GetCellIndex(vertex_from, 0);
+        enum class WalkState : uint8_t { UNKNOWN, ON_PATH, DONE };
+        std::vector<WalkState> walk_states(vertex_count_, WalkState::UNKNOWN);
+        std::vector<VertexId> tree_path;
+        for (VertexId vertex = 0; vertex < vertex_count_; ++vertex) {
+            VertexId tree_vertex = vertex;
+            while (walk_states[tree_vertex] == WalkState::UNKNOWN && prev_edges[tree_vertex] != NO_PREV_EDGE) {
+                walk_states[tree_vertex] = WalkState::ON_PATH;
+                tree_path.push_back(tree_vertex);
+                tree_vertex = graph_.GetEdge(prev_edges[tree_vertex]).from;
+            }
+            if (walk_states[tree_vertex] == WalkState::ON_PATH) {
+                return true;
+            }
+            for (const VertexId path_vertex : tree_path) {
+                walk_states[path_vertex] = WalkState::DONE;
+            }
+            tree_path.clear();
+        }
+        return false;
+    }
+
+    // The last edges of Dijkstra form a tree even with zero weights: an edge becomes the last
+    // one only when it makes the route strictly shorter.
+    void ComputeRowByDijkstra(VertexId vertex_from) {
+        Weight* const weights = routes_internal_data_.weights.data() + GetCellIndex(vertex_from, 0);
+        PrevEdgeId* const prev_edges = routes_internal_data_.prev_edges.data() + GetCellIndex(vertex_from, 0);
+        std::fill(weights, weights + vertex_count_, UNREACHABLE_WEIGHT);
+        std::fill(prev_edges, prev_edges + vertex_count_, NO_PREV_EDGE);
+        weights[vertex_from] = ZERO_WEIGHT;
+
+        using QueueItem = std::pair<Weight, VertexId>;
+        std::priority_queue<QueueItem, std::vector<QueueItem>, std::greater<QueueItem>> queue;
+        queue.push({ZERO_WEIGHT, vertex_from});
+        while (!queue.empty()) {
+            const auto [weight, vertex] = queue.top();
+            queue.pop();
+            if (weight > weights[vertex]) {
+                continue;
+            }
+            for (const EdgeId edge_id : graph_.GetIncidentEdges(vertex)) {
+                const auto& edge = graph_.GetEdge(edge_id);
+                const Weight candidate_weight = weight + edge.weight;
+                if (weights[edge.to] == UNREACHABLE_WEIGHT || candidate_weight < weights[edge.to]) {
+                    weights[edge.to] = candidate_weight;
+                    prev_edges[edge.to] = static_cast<PrevEdgeId>(edge_id);
+                    queue.push({candidate_weight, edge.to});
+                }
             }
         }
     }
 
+    // Grows the table to the current vertex count of the graph, old cells keep their places.
+    void ResizeRoutesInternalData() {
+        const size_t old_vertex_count = vertex_count_;
+        vertex_count_ = graph_.GetVertexCount();
+        RoutesInternalData resized{std::vector<Weight>(vertex_count_ * vertex_count_, UNREACHABLE_WEIGHT),
+                                   std::vector<PrevEdgeId>(vertex_count_ * vertex_count_, NO_PREV_EDGE)};
+        for (VertexId vertex_from = 0; vertex_from < old_vertex_count; ++vertex_from) {
+            const size_t old_row = vertex_from * old_vertex_count;
+            std::copy_n(routes_internal_data_.weights.begin() + old_row, old_vertex_count,
+                        resized.weights.begin() + GetCellIndex(vertex_from, 0));
+            std::copy_n(routes_internal_data_.prev_edges.begin() + old_row, old_vertex_count,
+                        resized.prev_edges.begin() + GetCellIndex(vertex_from, 0));
+        }
+        for (VertexId vertex = old_vertex_count; vertex < vertex_count_; ++vertex) {
+            resized.weights[GetCellIndex(vertex, vertex)] = ZERO_WEIGHT;
+        }
+        routes_internal_data_ = std::move(resized);
+    }
+
+    // Repairs the row of vertex_from after the edges of is_removed_edge were removed and
+    // the added_edges were added (Ramalingam-Reps). Vertices whose last edges lead back to
+    // a removed edge lose their routes and take the best entry from the rest of the tree,
+    // the heads of the added edges take the routes through them, and then Dijkstra spreads
+    // the changes from these vertices only. The last edges still form the shortest path
+    // tree, so BuildRoute walks the row the same way as after Floyd-Warshall.
+    void RepairRow(const StaticGraph<Weight>& static_graph, const StaticGraph<Weight>& reversed_graph,
+                   const std::vector<bool>& is_removed_edge, const std::vector<EdgeId>& added_edges,
+                   VertexId vertex_from) {
+        Weight* const weights = routes_internal_data_.weights.data() + GetCellIndex(vertex_from, 0);
+        PrevEdgeId* const prev_edges = routes_internal_data_.prev_edges.data() + GetCellIndex(vertex_from, 0);
+
+        // A walk that comes back to a vertex of its own path has met a cycle of last edges,
+        // which never reaches the source: the vertices of the path lose their routes then.
+        enum class RouteState : uint8_t { UNKNOWN, ON_PATH, KEPT, LOST };
+        std::vector<RouteState> route_states(vertex_count_, RouteState::UNKNOWN);
+        std::vector<VertexId> tree_path;
+        for (VertexId vertex = 0; vertex < vertex_count_; ++vertex) {
+            VertexId tree_vertex = vertex;
+            while (route_states[tree_vertex] == RouteState::UNKNOWN) {
+                const PrevEdgeId prev_edge = prev_edges[tree_vertex];
+                if (prev_edge == NO_PREV_EDGE || is_removed_edge[prev_edge]) {
+                    route_states[tree_vertex] = prev_edge == NO_PREV_EDGE ? RouteState::KEPT : RouteState::LOST;
+                    break;
+                }
+                route_states[tree_vertex] = RouteState::ON_PATH;
+                tree_path.push_back(tree_vertex);
+                tree_vertex = graph_.GetEdge(prev_edge).from;
+            }
+            const RouteState path_state = route_states[tree_vertex] == RouteState::ON_PATH
+                                          ? RouteState::LOST : route_states[tree_vertex];
+            for (const VertexId path_vertex : tree_path) {
+                route_states[path_vertex] = path_state;
+            }
+            tree_path.clear();
+        }
+
+        using QueueItem = std::pair<Weight, VertexId>;
+        std::priority_queue<QueueItem, std::vector<QueueItem>, std::greater<QueueItem>> queue;
+        const auto improve = [&](VertexId vertex, Weight candidate_weight, EdgeId edge_id) {
+            if (weights[vertex] == UNREACHABLE_WEIGHT || candidate_weight < weights[vertex]) {
+                weights[vertex] = candidate_weight;
+                prev_edges[vertex] = static_cast<PrevEdgeId>(edge_id);
+                queue.push({candidate_weight, vertex});
+            }
+        };
+        for (VertexId vertex = 0; vertex < vertex_count_; ++vertex) {
+            if (route_states[vertex] == RouteState::LOST) {
+                weights[vertex] = UNREACHABLE_WEIGHT;
+                prev_edges[vertex] = NO_PREV_EDGE;
+            }
+        }
+        for (VertexId vertex = 0; vertex < vertex_count_; ++vertex) {
+            if (route_states[vertex] != RouteState::LOST) {
+                continue;
+            }
+            for (const auto& edge : reversed_graph.GetIncidentEdges(vertex)) {
+                if (route_states[edge.to] == RouteState::KEPT && weights[edge.to] != UNREACHABLE_WEIGHT) {
+                    improve(vertex, weights[edge.to] + edge.weight, edge.edge_id);
+                }
+            }
+        }
+        for (const EdgeId edge_id : added_edges) {
+            const auto& edge = graph_.GetEdge(edge_id);
+            if (weights[edge.from] != UNREACHABLE_WEIGHT) {
+                improve(edge.to, weights[edge.from] + edge.weight, edge_id);
+            }
+        }
+
+        while (!queue.empty()) {
+            const auto [weight, vertex] = queue.top();
+            queue.pop();
+            if (weight > weights[vertex]) {
+                continue;
+            }
+            for (const auto& edge : static_graph.GetIncidentEdges(vertex)) {
+                improve(edge.to, weight + edge.weight, edge.edge_id);
+            }
+        }
+    }
+
+    static constexpr size_t TILE_SIZE = 64;
     static constexpr Weight ZERO_WEIGHT{};
+    static constexpr Weight UNREACHABLE_WEIGHT = std::numeric_limits<Weight>::has_infinity
+                                                 ? std::numeric_limits<Weight>::infinity()
+                                                 : std::numeric_limits<Weight>::max();
+    static constexpr PrevEdgeId NO_PREV_EDGE = std::numeric_limits<PrevEdgeId>::max();
     const Graph& graph_;
+    size_t vertex_count_;
     RoutesInternalData routes_internal_data_;
 };
 
 template <typename Weight>
-Router<Weight>::Router(const Graph& graph)
+Router<Weight>::Router(const Graph& graph, size_t thread_count)
     : graph_(graph)
-    , routes_internal_data_(graph.GetVertexCount(),
-                            std::vector<std::optional<RouteInternalData>>(graph.GetVertexCount()))
+    , vertex_count_(graph.GetVertexCount())
+    , routes_internal_data_{std::vector<Weight>(vertex_count_ * vertex_count_, UNREACHABLE_WEIGHT),
+                            std::vector<PrevEdgeId>(vertex_count_ * vertex_count_, NO_PREV_EDGE)}
 {
     InitializeRoutesInternalData(graph);
+    RelaxRoutesInternalData(thread_count);
+}
 
-    const size_t vertex_count = graph.GetVertexCount();
-    for (VertexId vertex_through = 0; vertex_through < vertex_count; ++vertex_through) {
-        RelaxRoutesInternalDataThroughVertex(vertex_count, vertex_through);
+template <typename Weight>
+Router<Weight>::Router(const Graph& graph, RoutesInternalData routes_internal_data)
+    : graph_(graph)
+    , vertex_count_(graph.GetVertexCount())
+    , routes_internal_data_(std::move(routes_internal_data))
+{
+    if (routes_internal_data_.weights.size() != vertex_count_ * vertex_count_
+        || routes_internal_data_.prev_edges.size() != vertex_count_ * vertex_count_) {
+        throw std::invalid_argument("Routes table doesn't match the graph");
     }
 }
 
 template <typename Weight>
-std::optional<typename Router<Weight>::RouteInfo> Router<Weight>::BuildRoute(VertexId from,
-                                                                             VertexId to) const {
-    const auto& route_internal_data = routes_internal_data_.at(from).at(to);
-    if (!route_internal_data) {
-        return std::nullopt;
-    }
-    const Weight weight = route_internal_data->weight;
-    std::vector<EdgeId> edges;
-    for (std::optional<EdgeId> edge_id = route_internal_data->prev_edge;
-         edge_id;
-         edge_id = routes_internal_data_[from][graph_.GetEdge(*edge_id).from]->prev_edge)
+bool Router<Weight>::FillRoute(VertexId from, VertexId to, RouteInfo& route_info) const {
+    if (from >= vertex_count_ || to >= vertex_count_) {
+        throw std::out_of_range("Vertex id is out of range");
+    }
+    const Weight weight = routes_internal_data_.weights[GetCellIndex(from, to)];
+    if (weight == UNREACHABLE_WEIGHT) {
+        return false;
+    }
+    auto& edges = route_info.edges;
+    edges.clear();
+    for (PrevEdgeId edge_id = routes_internal_data_.prev_edges[GetCellIndex(from, to)];
+         edge_id != NO_PREV_EDGE;
+         edge_id = routes_internal_data_.prev_edges[GetCellIndex(from, graph_.GetEdge(edge_id).from)])
     {
-        edges.push_back(*edge_id);
+        // A route has at most vertex_count_ - 1 edges, more of them means a broken table.
+        if (edges.size() == vertex_count_) {
+            throw std::logic_error("Last edges of the routes form a cycle");
+        }
+        edges.push_back(edge_id);
     }
     std::reverse(edges.begin(), edges.end());
+    route_info.weight = weight;
+    return true;
+}
 
-    return RouteInfo{weight, std::move(edges)};
+template <typename Weight>
+typename Router<Weight>::WeightMatrix Router<Weight>::BuildWeightMatrix(const std::vector<VertexId>& sources,
+                                                                        const std::vector<VertexId>& targets,
+                                                                        concurrency::ThreadPool&) const {
+    WeightMatrix weight_matrix(sources.size(), std::vector<std::optional<Weight>>(targets.size()));
+    for (size_t source_index = 0; source_index < sources.size(); ++source_index) {
+        for (size_t target_index = 0; target_index < targets.size(); ++target_index) {
+            if (sources[source_index] >= vertex_count_ || targets[target_index] >= vertex_count_) {
+                throw std::out_of_range("Vertex id is out of range");
+            }
+            const Weight weight = routes_internal_data_.weights[GetCellIndex(sources[source_index], targets[target_index])];
+            if (weight != UNREACHABLE_WEIGHT) {
+                weight_matrix[source_index][target_index] = weight;
+            }
+        }
+    }
+    return weight_matrix;
+}
+
+// A row stays exact unless its shortest path tree has a removed edge or an added edge
+// (u, v) makes the route to v shorter: a route improved by the added edges can be cut at
+// the first added edge that improves on the old route to its end. Only such rows and the
+// rows of new vertices are repaired.
+template <typename Weight>
+bool Router<Weight>::UpdateEdges(const std::vector<EdgeId>& removed_edges, const std::vector<EdgeId>& added_edges) {
+    if (graph_.GetEdgeCount() >= NO_PREV_EDGE) {
+        return false;
+    }
+    for (const EdgeId edge_id : added_edges) {
+        if (graph_.GetEdge(edge_id).weight < ZERO_WEIGHT) {
+            throw std::domain_error("Edges' weights should be non-negative");
+        }
+    }
+    const size_t old_vertex_count = vertex_count_;
+    if (graph_.GetVertexCount() != vertex_count_) {
+        ResizeRoutesInternalData();
+    }
+
+    std::vector<VertexId> rows_to_repair;
+    for (VertexId vertex_from = 0; vertex_from < vertex_count_; ++vertex_from) {
+        const size_t row_from = GetCellIndex(vertex_from, 0);
+        const auto is_in_tree = [&](EdgeId edge_id) {
+            return routes_internal_data_.prev_edges[row_from + graph_.GetEdge(edge_id).to] == edge_id;
+        };
+        const auto is_shortening = [&](EdgeId edge_id) {
+            const auto& edge = graph_.GetEdge(edge_id);
+            const Weight weight_to_edge = routes_internal_data_.weights[row_from + edge.from];
+            const Weight weight_to_end = routes_internal_data_.weights[row_from + edge.to];
+            return weight_to_edge != UNREACHABLE_WEIGHT
+                   && (weight_to_end == UNREACHABLE_WEIGHT || weight_to_edge + edge.weight < weight_to_end);
+        };
+        if (vertex_from >= old_vertex_count
+            || std::any_of(removed_edges.begin(), removed_edges.end(), is_in_tree)
+            || std::any_of(added_edges.begin(), added_edges.end(), is_shortening)) {
+            rows_to_repair.push_back(vertex_from);
+        }
+    }
+
+    if (rows_to_repair.empty()) {
+        return true;
+    }
+    std::vector<bool> is_removed_edge(graph_.GetEdgeCount(), false);
+    for (const EdgeId edge_id : removed_edges) {
+        is_removed_edge[edge_id] = true;
+    }
+    const StaticGraph<Weight> static_graph(graph_);
+    std::vector<std::pair<VertexId, typename StaticGraph<Weight>::IncidentEdge>> reversed_edges;
+    reversed_edges.reserve(static_graph.GetEdgeCount());
+    for (VertexId vertex = 0; vertex < vertex_count_; ++vertex) {
+        for (const auto& edge : static_graph.GetIncidentEdges(vertex)) {
+            reversed_edges.push_back({edge.to, {vertex, edge.weight, edge.edge_id}});
+        }
+    }
+    const StaticGraph<Weight> reversed_graph(vertex_count_, reversed_edges);
+
+    concurrency::ThreadPool thread_pool(std::min(concurrency::GetDefaultThreadCount(), rows_to_repair.size()));
+    thread_pool.ParallelFor(rows_to_repair.size(), [&](size_t index) {
+        RepairRow(static_graph, reversed_graph, is_removed_edge, added_edges, rows_to_repair[index]);
+    });
+    return true;
+}
+
+template <typename Weight>
+const typename Router<Weight>::RoutesInternalData& Router<Weight>::GetRoutesInternalData() const {
+    return routes_internal_data_;
 }
 
 }  // namespace graph
@@ -0,0 +1,141 @@
+#pragma once
+
+#include "graph.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <utility>
+#include <vector>
+
+namespace graph {
+
+// Scratch arrays of a single-source search: tentative weights, previous edges, potentials
+// for goal-directed searches, the heap and a path buffer. Every thread has its own
+// workspaces, kept between searches, so a search on a warmed-up thread allocates nothing.
+// A vertex counts as reached or settled only if its stamp equals the current generation,
+// so starting a search is O(1) instead of clearing the arrays.
+template <typename Weight>
+class SearchWorkspace {
+public:
+    using QueueItem = std::pair<Weight, VertexId>;
+
+    static constexpr EdgeId NO_EDGE = std::numeric_limits<EdgeId>::max();
+    // Searches that run two searches at once, like the bidirectional one, take
+    // a workspace per direction.
+    static constexpr size_t WORKSPACES_PER_THREAD = 2;
+
+    // The index-th workspace of the calling thread, ready for a new search over
+    // vertex_count vertices. It stays valid until the next Acquire of the same index
+    // on the same thread.
+    static SearchWorkspace& Acquire(size_t vertex_count, size_t index = 0);
+
+    bool IsReached(VertexId vertex) const {
+        return reach_stamps_[vertex] == generation_;
+    }
+
+    bool IsSettled(VertexId vertex) const {
+        return settle_stamps_[vertex] == generation_;
+    }
+
+    // Valid for reached vertices only.
+    Weight GetWeight(VertexId vertex) const {
+        return weights_[vertex];
+    }
+
+    // NO_EDGE for the source.
+    EdgeId GetPrevEdge(VertexId vertex) const {
+        return prev_edges_[vertex];
+    }
+
+    // Kept until the vertex is reached by a later search, so it should be set right
+    // before the vertex is first reached.
+    Weight GetPotential(VertexId vertex) const {
+        return potentials_[vertex];
+    }
+
+    void SetPotential(VertexId vertex, Weight potential) {
+        potentials_[vertex] = potential;
+    }
+
+    void Reach(VertexId vertex, Weight weight, EdgeId prev_edge) {
+        reach_stamps_[vertex] = generation_;
+        weights_[vertex] = weight;
+        prev_edges_[vertex] = prev_edge;
+    }
+
+    void Settle(VertexId vertex) {
+        settle_stamps_[vertex] = generation_;
+    }
+
+    // A min-heap by (key, vertex), so it pops in the same order as
+    // std::priority_queue<QueueItem, std::vector<QueueItem>, std::greater<QueueItem>>.
+    bool IsQueueEmpty() const {
+        return heap_.empty();
+    }
+
+    const QueueItem& GetQueueTop() const {
+        return heap_.front();
+    }
+
+    void PushQueue(Weight key, VertexId vertex) {
+        heap_.push_back({key, vertex});
+        std::push_heap(heap_.begin(), heap_.end(), std::greater<QueueItem>());
+    }
+
+    QueueItem PopQueue() {
+        std::pop_heap(heap_.begin(), heap_.end(), std::greater<QueueItem>());
+        const QueueItem item = heap_.back();
+        heap_.pop_back();
+        return item;
+    }
+
+    // Empty at the start of a search.
+    std::vector<EdgeId>& GetPathBuffer() {
+        return path_buffer_;
+    }
+
+private:
+    void Prepare(size_t vertex_count);
+
+    std::vector<Weight> weights_;
+    std::vector<EdgeId> prev_edges_;
+    std::vector<Weight> potentials_;
+    std::vector<uint32_t> reach_stamps_;
+    std::vector<uint32_t> settle_stamps_;
+    std::vector<QueueItem> heap_;
+    std::vector<EdgeId> path_buffer_;
+    uint32_t generation_ = 0;
+};
+
+template <typename Weight>
+SearchWorkspace<Weight>& SearchWorkspace<Weight>::Acquire(size_t vertex_count, size_t index) {
+    thread_local std::array<SearchWorkspace, WORKSPACES_PER_THREAD> workspaces;
+    SearchWorkspace& workspace = workspaces.at(index);
+    workspace.Prepare(vertex_count);
+    return workspace;
+}
+
+// The stamps are cleared only when the generation counter wraps around.
+template <typename Weight>
+void SearchWorkspace<Weight>::Prepare(size_t vertex_count) {
+    if (weights_.size() < vertex_count) {
+        weights_.resize(vertex_count);
+        prev_edges_.resize(vertex_count);
+        potentials_.resize(vertex_count);
+        reach_stamps_.resize(vertex_count, 0);
+        settle_stamps_.resize(vertex_count, 0);
+    }
+    heap_.clear();
+    path_buffer_.clear();
+    ++generation_;
+    if (generation_ == 0) {
+        std::fill(reach_stamps_.begin(), reach_stamps_.end(), 0);
+        std::fill(settle_stamps_.begin(), settle_stamps_.end(), 0);
+        generation_ = 1;
+    }
+}
+
+}  // namespace graph
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdlib>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+namespace serialization {
+
+// Values are written as raw bytes in the host byte order, so the files are meant to be
+// read back on the same platform by a build of the same format version.
+template <typename Value>
+void WriteValue(std::ostream& output, const Value& value) {
+    static_assert(std::is_trivially_copyable_v<Value>);
+    output.write(reinterpret_cast<const char*>(&value), sizeof(Value));
+}
+
+template <typename Value>
+bool ReadValue(std::istream& input, Value& value) {
+    static_assert(std::is_trivially_copyable_v<Value>);
+    return static_cast<bool>(input.read(reinterpret_cast<char*>(&value), sizeof(Value)));
+}
+
+template <typename Value>
+void WriteVector(std::ostream& output, const std::vector<Value>& values) {
+    static_assert(std::is_trivially_copyable_v<Value>);
+    WriteValue(output, static_cast<uint64_t>(values.size()));
+    output.write(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(Value));
+}
+
+// max_size guards against allocating a huge vector for a corrupted length.
+template <typename Value>
+bool ReadVector(std::istream& input, std::vector<Value>& values, uint64_t max_size) {
+    static_assert(std::is_trivially_copyable_v<Value>);
+    uint64_t size = 0;
+    if (!ReadValue(input, size) || size > max_size) {
+        return false;
+    }
+    values.resize(size);
+    return static_cast<bool>(input.read(reinterpret_cast<char*>(values.data()), size * sizeof(Value)));
+}
+
+inline void WriteString(std::ostream& output, std::string_view value) {
+    WriteValue(output, static_cast<uint64_t>(value.size()));
+    output.write(value.data(), value.size());
+}
+
+inline bool ReadString(std::istream& input, std::string& value, uint64_t max_size) {
+    uint64_t size = 0;
+    if (!ReadValue(input, size) || size > max_size) {
+        return false;
+    }
+    value.resize(size);
+    return static_cast<bool>(input.read(value.data(), size));
+}
+
+// 64-bit FNV-1a. Unlike std::hash it gives the same result in every process and build,
+// so it can name files shared between runs.
+class ContentHasher {
+public:
+    void AddBytes(const void* data, size_t size) {
+        const auto* bytes = static_cast<const unsigned char*>(data);
+        for (size_t index = 0; index < size; ++index) {
+            hash_ = (hash_ ^ bytes[index]) * PRIME;
+        }
+    }
+
+    template <typename Value>
+    void AddValue(const Value& value) {
+        static_assert(std::is_trivially_copyable_v<Value>);
+        AddBytes(&value, sizeof(Value));
+    }
+
+    // The length goes first, so that "ab" + "c" and "a" + "bc" differ.
+    void AddString(std::string_view value) {
+        AddValue(static_cast<uint64_t>(value.size()));
+        AddBytes(value.data(), value.size());
+    }
+
+    uint64_t GetHash() const {
+        return hash_;
+    }
+
+private:
+    static constexpr uint64_t OFFSET_BASIS = 14695981039346656037ULL;
+    static constexpr uint64_t PRIME = 1099511628211ULL;
+    uint64_t hash_ = OFFSET_BASIS;
+};
+
+} // namespace serialization
@@ -0,0 +1,145 @@
+#define _USE_MATH_DEFINES
+#include "spatial_index.h"
+
+#include <algorithm>
+#include <cmath>
+#include <tuple>
+
+namespace transport {
+
+namespace {
+
+constexpr double DEGREES_IN_RADIAN = 180.0 / M_PI;
+constexpr double MAX_LNG = 180.0;
+
+bool IsNearer(const std::pair<StopId, double>& lhs, const std::pair<StopId, double>& rhs) {
+    return std::tie(lhs.second, lhs.first) < std::tie(rhs.second, rhs.first);
+}
+
+} // namespace
+
+SpatialIndex::SpatialIndex(std::vector<Point> points)
+    : points_(std::move(points)) {
+    Build(0, points_.size(), true);
+}
+
+bool SpatialIndex::IsInBox(const geo::Coordinates& coordinates, const geo::Coordinates& min_corner,
+                           const geo::Coordinates& max_corner) {
+    if (coordinates.lat < min_corner.lat || coordinates.lat > max_corner.lat) {
+        return false;
+    }
+    if (min_corner.lng <= max_corner.lng) {
+        return min_corner.lng <= coordinates.lng && coordinates.lng <= max_corner.lng;
+    }
+    return min_corner.lng <= coordinates.lng || coordinates.lng <= max_corner.lng;
+}
+
+size_t SpatialIndex::GetSize() const {
+    return points_.size();
+}
+
+std::vector<StopId> SpatialIndex::FindInBox(const geo::Coordinates& min_corner, const geo::Coordinates& max_corner) const {
+    std::vector<StopId> stop_ids;
+    for (const Point* point : CollectInBox(min_corner, max_corner)) {
+        stop_ids.push_back(point->stop_id);
+    }
+    return stop_ids;
+}
+
+// The candidates come from the box around the circle: within the angle on the latitude, and
+// on the longitude within the angle at which a meridian touches the circle. The box takes
+// all longitudes if the circle reaches a pole.
+std::vector<std::pair<StopId, double>> SpatialIndex::FindWithinRadius(const geo::Coordinates& center, double radius) const {
+    std::vector<std::pair<StopId, double>> stops;
+    if (radius < 0.0) {
+        return stops;
+    }
+    const double angle = radius / EARTH_RADIUS + ANGLE_MARGIN;
+    const double lat_delta = angle * DEGREES_IN_RADIAN;
+    const double sin_lng_delta = std::sin(angle) / std::cos(center.lat / DEGREES_IN_RADIAN);
+    geo::Coordinates min_corner{center.lat - lat_delta, -MAX_LNG};
+    geo::Coordinates max_corner{center.lat + lat_delta, MAX_LNG};
+    if (min_corner.lat > -90.0 && max_corner.lat < 90.0 && sin_lng_delta < 1.0) {
+        const double lng_delta = std::asin(sin_lng_delta) * DEGREES_IN_RADIAN;
+        min_corner.lng = center.lng - lng_delta;
+        max_corner.lng = center.lng + lng_delta;
+        if (min_corner.lng < -MAX_LNG) {
+            min_corner.lng += 2.0 * MAX_LNG;
+        }
+        if (max_corner.lng > MAX_LNG) {
+            max_corner.lng -= 2.0 * MAX_LNG;
+        }
+    }
+    for (const Point* point : CollectInBox(min_corner, max_corner)) {
+        const double distance = geo::ComputeDistance(center, point->coordinates);
+        if (distance <= radius) {
+            stops.push_back({point->stop_id, distance});
+        }
+    }
+    std::sort(stops.begin(), stops.end(), IsNearer);
+    return stops;
+}
+
+std::vector<std::pair<StopId, double>> SpatialIndex::FindNearest(const geo::Coordinates& center, size_t count,
+                                                                 double max_distance) const {
+    if (count == 0) {
+        return {};
+    }
+    const double max_search_radius = std::min(max_distance, M_PI * EARTH_RADIUS);
+    double radius = std::min(INITIAL_SEARCH_RADIUS, max_search_radius);
+    while (true) {
+        auto stops = FindWithinRadius(center, radius);
+        if (stops.size() >= count || radius >= max_search_radius) {
+            stops.resize(std::min(stops.size(), count));
+            return stops;
+        }
+        radius = std::min(4.0 * radius, max_search_radius);
+    }
+}
+
+void SpatialIndex::Build(size_t begin, size_t end, bool is_lat_split) {
+    if (end - begin < 2) {
+        return;
+    }
+    const size_t middle = begin + (end - begin) / 2;
+    std::nth_element(points_.begin() + begin, points_.begin() + middle, points_.begin() + end,
+                     [is_lat_split](const Point& lhs, const Point& rhs) {
+                         return is_lat_split ? lhs.coordinates.lat < rhs.coordinates.lat
+                                             : lhs.coordinates.lng < rhs.coordinates.lng;
+                     });
+    Build(begin, middle, !is_lat_split);
+    Build(middle + 1, end, !is_lat_split);
+}
+
+std::vector<const SpatialIndex::Point*> SpatialIndex::CollectInBox(const geo::Coordinates& min_corner,
+                                                                   const geo::Coordinates& max_corner) const {
+    std::vector<const Point*> points;
+    if (min_corner.lng <= max_corner.lng) {
+        CollectInBox(0, points_.size(), true, min_corner, max_corner, points);
+    } else {
+        CollectInBox(0, points_.size(), true, min_corner, {max_corner.lat, MAX_LNG}, points);
+        CollectInBox(0, points_.size(), true, {min_corner.lat, -MAX_LNG}, max_corner, points);
+    }
+    return points;
+}
+
+void SpatialIndex::CollectInBox(size_t begin, size_t end, bool is_lat_split, const geo::Coordinates& min_corner,
+                                const geo::Coordinates& max_corner, std::vector<const Point*>& points) const {
+    if (begin >= end) {
+        return;
+    }
+    const size_t middle = begin + (end - begin) / 2;
+    const Point& point = points_[middle];
+    const double value = is_lat_split ? point.coordinates.lat : point.coordinates.lng;
+    if ((is_lat_split ? min_corner.lat : min_corner.lng) <= value) {
+        CollectInBox(begin, middle, !is_lat_split, min_corner, max_corner, points);
+    }
+    if (IsInBox(point.coordinates, min_corner, max_corner)) {
+        points.push_back(&point);
+    }
+    if (value <= (is_lat_split ? max_corner.lat : max_corner.lng)) {
+        CollectInBox(middle + 1, end, !is_lat_split, min_corner, max_corner, points);
+    }
+}
+
+} // namespace transport
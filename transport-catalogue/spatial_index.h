@@ -0,0 +1,52 @@
+#pragma once
+
+#include "domain.h"
+#include "geo.h"
+
+#include <cstdlib>
+#include <utility>
+#include <vector>
+
+namespace transport {
+
+// Static k-d tree over stop coordinates, split by latitude and longitude in turn. The tree
+// is implicit: the median of every range of points_ is its root. Longitudes are expected
+// in [-180, 180], a box with min longitude greater than max longitude crosses the antimeridian.
+class SpatialIndex {
+public:
+    struct Point {
+        geo::Coordinates coordinates;
+        StopId stop_id = 0;
+    };
+
+    SpatialIndex() = default;
+    explicit SpatialIndex(std::vector<Point> points);
+
+    static bool IsInBox(const geo::Coordinates& coordinates, const geo::Coordinates& min_corner,
+                        const geo::Coordinates& max_corner);
+
+    size_t GetSize() const;
+
+    std::vector<StopId> FindInBox(const geo::Coordinates& min_corner, const geo::Coordinates& max_corner) const;
+    // Pairs of the stops at most radius meters from center and the distances, nearest first.
+    std::vector<std::pair<StopId, double>> FindWithinRadius(const geo::Coordinates& center, double radius) const;
+    // The count nearest stops at most max_distance meters from center, nearest first. The search
+    // radius grows until enough stops are found, so a sparse neighbourhood costs a few box queries.
+    std::vector<std::pair<StopId, double>> FindNearest(const geo::Coordinates& center, size_t count, double max_distance) const;
+
+private:
+    static constexpr double EARTH_RADIUS = 6371000.0;
+    // Covers the rounding of geo::ComputeDistance, in radians.
+    static constexpr double ANGLE_MARGIN = 1e-7;
+    static constexpr double INITIAL_SEARCH_RADIUS = 500.0;
+
+    void Build(size_t begin, size_t end, bool is_lat_split);
+    std::vector<const Point*> CollectInBox(const geo::Coordinates& min_corner, const geo::Coordinates& max_corner) const;
+    // The box doesn't cross the antimeridian here.
+    void CollectInBox(size_t begin, size_t end, bool is_lat_split, const geo::Coordinates& min_corner,
+                      const geo::Coordinates& max_corner, std::vector<const Point*>& points) const;
+
+    std::vector<Point> points_;
+};
+
+} // namespace transport
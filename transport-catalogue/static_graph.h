@@ -0,0 +1,92 @@
+#pragma once
+
+#include "graph.h"
+#include "ranges.h"
+
+#include <cstdlib>
+#include <utility>
+#include <vector>
+
+namespace graph {
+
+// Read-only graph in compressed sparse row form: the outgoing edges of all vertices lie in
+// one array sorted by source, so a search walks them sequentially.
+template <typename Weight>
+class StaticGraph {
+public:
+    struct IncidentEdge {
+        VertexId to;
+        Weight weight;
+        EdgeId edge_id;
+    };
+
+private:
+    using IncidentEdgesRange = ranges::Range<typename std::vector<IncidentEdge>::const_iterator>;
+
+public:
+    StaticGraph() = default;
+    explicit StaticGraph(const DirectedWeightedGraph<Weight>& graph);
+    StaticGraph(size_t vertex_count, const std::vector<std::pair<VertexId, IncidentEdge>>& edges_by_source);
+
+    size_t GetVertexCount() const;
+    size_t GetEdgeCount() const;
+    IncidentEdgesRange GetIncidentEdges(VertexId vertex) const;
+
+private:
+    void Build(size_t vertex_count, const std::vector<std::pair<VertexId, IncidentEdge>>& edges_by_source);
+
+    std::vector<size_t> offsets_;
+    std::vector<IncidentEdge> incident_edges_;
+};
+
+template <typename Weight>
+StaticGraph<Weight>::StaticGraph(const DirectedWeightedGraph<Weight>& graph) {
+    std::vector<std::pair<VertexId, IncidentEdge>> edges_by_source;
+    edges_by_source.reserve(graph.GetEdgeCount());
+    for (VertexId vertex = 0; vertex < graph.GetVertexCount(); ++vertex) {
+        for (const EdgeId edge_id : graph.GetIncidentEdges(vertex)) {
+            const auto& edge = graph.GetEdge(edge_id);
+            edges_by_source.push_back({edge.from, {edge.to, edge.weight, edge_id}});
+        }
+    }
+    Build(graph.GetVertexCount(), edges_by_source);
+}
+
+template <typename Weight>
+StaticGraph<Weight>::StaticGraph(size_t vertex_count, const std::vector<std::pair<VertexId, IncidentEdge>>& edges_by_source) {
+    Build(vertex_count, edges_by_source);
+}
+
+template <typename Weight>
+size_t StaticGraph<Weight>::GetVertexCount() const {
+    return offsets_.empty() ? 0 : offsets_.size() - 1;
+}
+
+template <typename Weight>
+size_t StaticGraph<Weight>::GetEdgeCount() const {
+    return incident_edges_.size();
+}
+
+template <typename Weight>
+typename StaticGraph<Weight>::IncidentEdgesRange StaticGraph<Weight>::GetIncidentEdges(VertexId vertex) const {
+    return {incident_edges_.begin() + offsets_.at(vertex), incident_edges_.begin() + offsets_.at(vertex + 1)};
+}
+
+template <typename Weight>
+void StaticGraph<Weight>::Build(size_t vertex_count, const std::vector<std::pair<VertexId, IncidentEdge>>& edges_by_source) {
+    // Counting sort by source keeps the edges of a vertex in their original order.
+    offsets_.assign(vertex_count + 1, 0);
+    for (const auto& [from, incident_edge] : edges_by_source) {
+        ++offsets_.at(from + 1);
+    }
+    for (size_t vertex = 0; vertex < vertex_count; ++vertex) {
+        offsets_[vertex + 1] += offsets_[vertex];
+    }
+    incident_edges_.resize(edges_by_source.size());
+    std::vector<size_t> positions(offsets_.begin(), offsets_.end() - 1);
+    for (const auto& [from, incident_edge] : edges_by_source) {
+        incident_edges_[positions[from]++] = incident_edge;
+    }
+}
+
+}  // namespace graph
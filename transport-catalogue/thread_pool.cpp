@@ -0,0 +1,88 @@
+#include "thread_pool.h"
+
+#include <algorithm>
+
+namespace concurrency {
+
+size_t GetDefaultThreadCount() {
+    return std::max(1u, std::thread::hardware_concurrency());
+}
+
+ThreadPool::ThreadPool(size_t thread_count) {
+    for (size_t i = 1; i < thread_count; ++i) {
+        workers_.emplace_back([this] { WorkerLoop(); });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard lock(mutex_);
+        is_stopping_ = true;
+    }
+    has_tasks_.notify_all();
+    for (std::thread& worker : workers_) {
+        worker.join();
+    }
+}
+
+size_t ThreadPool::GetThreadCount() const {
+    return workers_.size() + 1;
+}
+
+void ThreadPool::ParallelFor(size_t task_count, const std::function<void(size_t)>& task) {
+    if (task_count == 0) {
+        return;
+    }
+    std::lock_guard call_lock(call_mutex_);
+    std::unique_lock lock(mutex_);
+    task_ = &task;
+    task_count_ = task_count;
+    next_task_index_ = 0;
+    unfinished_task_count_ = task_count;
+    exception_ = nullptr;
+    ++generation_;
+    has_tasks_.notify_all();
+
+    RunTasks(lock);
+    tasks_done_.wait(lock, [this] { return unfinished_task_count_ == 0; });
+    task_ = nullptr;
+    if (exception_) {
+        std::rethrow_exception(std::exchange(exception_, nullptr));
+    }
+}
+
+void ThreadPool::WorkerLoop() {
+    size_t seen_generation = 0;
+    std::unique_lock lock(mutex_);
+    while (true) {
+        has_tasks_.wait(lock, [&] { return is_stopping_ || generation_ != seen_generation; });
+        if (is_stopping_) {
+            return;
+        }
+        seen_generation = generation_;
+        RunTasks(lock);
+    }
+}
+
+void ThreadPool::RunTasks(std::unique_lock<std::mutex>& lock) {
+    while (next_task_index_ < task_count_) {
+        const size_t task_index = next_task_index_++;
+        const auto& task = *task_;
+        lock.unlock();
+        std::exception_ptr exception;
+        try {
+            task(task_index);
+        } catch (...) {
+            exception = std::current_exception();
+        }
+        lock.lock();
+        if (exception && !exception_) {
+            exception_ = exception;
+        }
+        if (--unfinished_task_count_ == 0) {
+            tasks_done_.notify_all();
+        }
+    }
+}
+
+} // namespace concurrency
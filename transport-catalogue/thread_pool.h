@@ -0,0 +1,48 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdlib>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace concurrency {
+
+size_t GetDefaultThreadCount();
+
+class ThreadPool {
+public:
+    explicit ThreadPool(size_t thread_count = GetDefaultThreadCount());
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+    ~ThreadPool();
+
+    size_t GetThreadCount() const;
+
+    // Calls task(index) for every index in [0, task_count) on the pool threads and the
+    // calling thread, returns when all calls are finished. The first exception thrown by
+    // a task is rethrown here. Concurrent calls are served one after another.
+    void ParallelFor(size_t task_count, const std::function<void(size_t)>& task);
+
+private:
+    void WorkerLoop();
+    void RunTasks(std::unique_lock<std::mutex>& lock);
+
+    std::vector<std::thread> workers_;
+    std::mutex call_mutex_;
+    std::mutex mutex_;
+    std::condition_variable has_tasks_;
+    std::condition_variable tasks_done_;
+    const std::function<void(size_t)>* task_ = nullptr;
+    size_t task_count_ = 0;
+    size_t next_task_index_ = 0;
+    size_t unfinished_task_count_ = 0;
+    size_t generation_ = 0;
+    std::exception_ptr exception_;
+    bool is_stopping_ = false;
+};
+
+} // namespace concurrency
@@ -1,28 +1,71 @@
 #include "transport_catalogue.h"
 
 #include <algorithm>
+#include <stdexcept>
+#include <tuple>
+
+using namespace std::literals;
 
 namespace transport {
 
-void TransportCatalogue::AddStop(const std::string& stop_name, const geo::Coordinates& stop_coordinates) {
-    stops_.push_back({stop_name, stop_coordinates});
+void TransportCatalogue::AddStop(std::string_view stop_name, const geo::Coordinates& stop_coordinates) {
+    stops_.push_back({static_cast<StopId>(stops_.size()), InternName(stop_name), stop_coordinates});
     stop_info_by_stop_name_[stops_.back().name] = &stops_.back();
-    routes_through_stop_by_stop_name_[stops_.back().name];
+    routes_through_stop_by_stop_id_.emplace_back();
 }
 
+// A distance to an unknown stop can never be asked for, so it is ignored. Any route through
+// the changed road, in either direction, passes stop_from, so only the statistics of those
+// routes are recomputed.
 void TransportCatalogue::AddDistance(std::string_view stop_from, std::string_view stop_to, int distance) {
-    distances_between_stops_[{GetStop(stop_from), GetStop(stop_to)}] = distance;
-    if (!distances_between_stops_.count({GetStop(stop_to), GetStop(stop_from)})) {
-        distances_between_stops_[{GetStop(stop_to), GetStop(stop_from)}] = distance;
+    const Stop* stop_from_info = GetStop(stop_from);
+    const Stop* stop_to_info = GetStop(stop_to);
+    if (!stop_from_info || !stop_to_info) {
+        return;
+    }
+    const StopId stop_from_id = stop_from_info->id;
+    const StopId stop_to_id = stop_to_info->id;
+    distances_between_stops_.Set(stop_from_id, stop_to_id, distance);
+    for (const std::string_view route_name : routes_through_stop_by_stop_id_[stop_from_id]) {
+        const Route& route = *route_info_by_route_name_.at(route_name);
+        route_info_by_route_id_[route.id] = CalculateRouteInfo(route);
     }
 }
+
+void TransportCatalogue::ReserveDistances(size_t distance_count) {
+    distances_between_stops_.Reserve(distance_count);
+}
     
-void TransportCatalogue::AddRoute(const std::string& route_name, const std::vector<std::string>& route_stops, bool is_roundtrip) {
-    routes_.push_back({route_name, route_stops, is_roundtrip});
+// The stop names are resolved to ids once, here.
+void TransportCatalogue::AddRoute(std::string_view route_name, const std::vector<std::string_view>& route_stops, bool is_roundtrip,
+                                  std::vector<double> departure_times) {
+    std::vector<StopId> stop_ids;
+    stop_ids.reserve(route_stops.size());
+    for (const std::string_view stop_name : route_stops) {
+        stop_ids.push_back(stop_info_by_stop_name_.at(stop_name)->id);
+    }
+    Route route{static_cast<RouteId>(routes_.size()), InternName(route_name), std::move(stop_ids), is_roundtrip,
+                std::move(departure_times)};
+    const RouteInfo route_info = CalculateRouteInfo(route);
+    RemoveRoute(route_name);
+    routes_.push_back(std::move(route));
+    route_info_by_route_id_.push_back(route_info);
     route_info_by_route_name_[routes_.back().name] = &routes_.back();
-    for (const std::string& stop_name : route_stops) {
-        routes_through_stop_by_stop_name_.at(stop_name).insert(routes_.back().name);
+    for (const StopId stop_id : routes_.back().stops) {
+        routes_through_stop_by_stop_id_[stop_id].insert(routes_.back().name);
+    }
+}
+
+// The route itself stays in routes_, so its id is not reused. Its name stays in the arena.
+void TransportCatalogue::RemoveRoute(std::string_view route_name) {
+    const auto it = route_info_by_route_name_.find(route_name);
+    if (it == route_info_by_route_name_.end()) {
+        return;
+    }
+    for (const StopId stop_id : it->second->stops) {
+        routes_through_stop_by_stop_id_[stop_id].erase(route_name);
     }
+    route_info_by_route_name_.erase(it);
 }
 
 const Stop* TransportCatalogue::GetStop(std::string_view stop_name) const {
@@ -32,6 +75,10 @@ const Stop* TransportCatalogue::GetStop(std::string_view stop_name) const {
     return stop_info_by_stop_name_.at(stop_name);
 }
 
+const Stop& TransportCatalogue::GetStopById(StopId stop_id) const {
+    return stops_.at(stop_id);
+}
+
 const Route* TransportCatalogue::GetRoute(std::string_view route_name) const {
     if (!route_info_by_route_name_.count(route_name)) {
         return nullptr;
@@ -40,31 +87,161 @@ const Route* TransportCatalogue::GetRoute(std::string_view route_name) const {
 }
     
 int TransportCatalogue::GetDistance(std::string_view stop_from, std::string_view stop_to) const {
-    return distances_between_stops_.at({GetStop(stop_from), GetStop(stop_to)});
+    return GetDistance(stop_info_by_stop_name_.at(stop_from)->id, stop_info_by_stop_name_.at(stop_to)->id);
 }    
 
+int TransportCatalogue::GetDistance(StopId stop_from, StopId stop_to) const {
+    const auto distance = distances_between_stops_.Find(stop_from, stop_to);
+    if (!distance) {
+        throw std::out_of_range("Unknown distance between stops "s + std::string(stops_[stop_from].name) + " and "s
+                                + std::string(stops_[stop_to].name));
+    }
+    return *distance;
+}
+
 TransportCatalogue::RouteInfo TransportCatalogue::GetRouteInfo(std::string_view route_name) const {
-    if (!route_info_by_route_name_.count(route_name)) {
+    const Route* route = GetRoute(route_name);
+    if (!route) {
+        return {0, 0, 0, 0.0};
+    }
+    return route_info_by_route_id_[route->id];
+}
+
+std::string_view TransportCatalogue::InternName(std::string_view name) {
+    if (const auto it = stop_info_by_stop_name_.find(name); it != stop_info_by_stop_name_.end()) {
+        return it->first;
+    }
+    if (const auto it = route_info_by_route_name_.find(name); it != route_info_by_route_name_.end()) {
+        return it->first;
+    }
+    return names_.Store(name);
+}
+
+TransportCatalogue::RouteInfo TransportCatalogue::CalculateRouteInfo(const Route& route) const {
+    if (route.stops.empty()) {
         return {0, 0, 0, 0.0};
     }
-    Route route = *GetRoute(route_name);
     int stop_count = route.stops.size();
     if (!route.is_roundtrip) {
         stop_count = (stop_count * 2) - 1;
     }
     int unique_stop_count = std::unordered_set(route.stops.begin(), route.stops.end()).size();
-    int real_route_length = CalculateRealRouteLength(*route_info_by_route_name_.at(route_name));
-    double geo_route_length = CalculateGeoRouteLength(*route_info_by_route_name_.at(route_name));
+    int real_route_length = CalculateRealRouteLength(route);
+    double geo_route_length = CalculateGeoRouteLength(route);
     return {stop_count, unique_stop_count, real_route_length, real_route_length / geo_route_length};
 }
 
 const std::unordered_set<std::string_view>* TransportCatalogue::GetRoutesThroughStop(std::string_view stop_name) const {
-    if (!routes_through_stop_by_stop_name_.count(stop_name)) {
+    const Stop* stop = GetStop(stop_name);
+    if (!stop) {
         return nullptr;
     }
-    return &routes_through_stop_by_stop_name_.at(stop_name);
+    return &routes_through_stop_by_stop_id_[stop->id];
 }
     
+void TransportCatalogue::BuildSpatialIndex() {
+    std::vector<SpatialIndex::Point> points;
+    points.reserve(stops_.size());
+    for (const Stop& stop : stops_) {
+        points.push_back({stop.coordinates, stop.id});
+    }
+    stops_spatial_index_ = SpatialIndex(std::move(points));
+}
+
+std::vector<std::pair<const Stop*, double>> TransportCatalogue::FindNearestStops(const geo::Coordinates& point, size_t count,
+                                                                                 double max_distance) const {
+    std::vector<std::pair<StopId, double>> nearest_stops = stops_spatial_index_.FindNearest(point, count, max_distance);
+    for (StopId stop_id = stops_spatial_index_.GetSize(); stop_id < stops_.size(); ++stop_id) {
+        const double distance = geo::ComputeDistance(point, stops_[stop_id].coordinates);
+        if (distance <= max_distance) {
+            nearest_stops.push_back({stop_id, distance});
+        }
+    }
+    std::sort(nearest_stops.begin(), nearest_stops.end(), [](const auto& lhs, const auto& rhs) {
+        return std::tie(lhs.second, lhs.first) < std::tie(rhs.second, rhs.first);
+    });
+    nearest_stops.resize(std::min(nearest_stops.size(), count));
+    std::vector<std::pair<const Stop*, double>> stops;
+    stops.reserve(nearest_stops.size());
+    for (const auto& [stop_id, distance] : nearest_stops) {
+        stops.push_back({&stops_[stop_id], distance});
+    }
+    return stops;
+}
+
+std::vector<const Stop*> TransportCatalogue::FindStopsInBox(const geo::Coordinates& min_corner,
+                                                            const geo::Coordinates& max_corner) const {
+    std::vector<const Stop*> stops;
+    for (const StopId stop_id : stops_spatial_index_.FindInBox(min_corner, max_corner)) {
+        stops.push_back(&stops_[stop_id]);
+    }
+    for (StopId stop_id = stops_spatial_index_.GetSize(); stop_id < stops_.size(); ++stop_id) {
+        if (SpatialIndex::IsInBox(stops_[stop_id].coordinates, min_corner, max_corner)) {
+            stops.push_back(&stops_[stop_id]);
+        }
+    }
+    std::sort(stops.begin(), stops.end(), [](const Stop* lhs, const Stop* rhs) {
+        return lhs->name < rhs->name;
+    });
+    return stops;
+}
+
+void TransportCatalogue::BuildNameSearchIndex() {
+    std::vector<NameSearchIndex::Name> names;
+    names.reserve(stop_info_by_stop_name_.size() + route_info_by_route_name_.size());
+    for (const auto [stop_name, stop_ptr] : stop_info_by_stop_name_) {
+        names.push_back({stop_name, NameKind::STOP});
+    }
+    for (const auto [route_name, route_ptr] : route_info_by_route_name_) {
+        names.push_back({route_name, NameKind::ROUTE});
+    }
+    name_search_index_ = NameSearchIndex(std::move(names));
+    name_indexed_stop_count_ = stops_.size();
+    name_indexed_route_count_ = routes_.size();
+}
+
+// Removed routes stay in the index, so more matches are asked for until enough are left.
+std::vector<NameMatch> TransportCatalogue::SearchNames(std::string_view query, size_t count) const {
+    std::vector<NameMatch> matches;
+    if (count == 0) {
+        return matches;
+    }
+    for (size_t index_count = count; ; index_count *= 2) {
+        matches = name_search_index_.Find(query, index_count);
+        const bool is_index_exhausted = matches.size() < index_count;
+        matches.erase(std::remove_if(matches.begin(), matches.end(), [this](const NameMatch& match) {
+                          return match.kind == NameKind::ROUTE && !GetRoute(match.name);
+                      }),
+                      matches.end());
+        if (is_index_exhausted || matches.size() >= count) {
+            break;
+        }
+    }
+    for (StopId stop_id = name_indexed_stop_count_; stop_id < stops_.size(); ++stop_id) {
+        if (const auto distance = NameSearchIndex::MatchName(query, stops_[stop_id].name)) {
+            matches.push_back({stops_[stop_id].name, NameKind::STOP, *distance});
+        }
+    }
+    for (RouteId route_id = name_indexed_route_count_; route_id < routes_.size(); ++route_id) {
+        const Route& route = routes_[route_id];
+        if (GetRoute(route.name) != &route) {
+            continue;
+        }
+        if (const auto distance = NameSearchIndex::MatchName(query, route.name)) {
+            matches.push_back({route.name, NameKind::ROUTE, *distance});
+        }
+    }
+    std::sort(matches.begin(), matches.end(), [](const NameMatch& lhs, const NameMatch& rhs) {
+        return std::tie(lhs.distance, lhs.name, lhs.kind) < std::tie(rhs.distance, rhs.name, rhs.kind);
+    });
+    matches.erase(std::unique(matches.begin(), matches.end(), [](const NameMatch& lhs, const NameMatch& rhs) {
+                      return lhs.name == rhs.name && lhs.kind == rhs.kind;
+                  }),
+                  matches.end());
+    matches.resize(std::min(matches.size(), count));
+    return matches;
+}
+
 const std::unordered_map<std::string_view, const Route*>& TransportCatalogue::GetAllRoutes() const {  
     return route_info_by_route_name_;
 }
@@ -89,8 +266,8 @@ int TransportCatalogue::CalculateRealRouteLength(const Route& route) const {
 double TransportCatalogue::CalculateGeoRouteLength(const Route& route) const {
     std::vector<geo::Coordinates> stops_coords;
     stops_coords.reserve(route.stops.size());   
-    for (const std::string& stop_name : route.stops) {
-        stops_coords.push_back(GetStop(stop_name)->coordinates);
+    for (const StopId stop_id : route.stops) {
+        stops_coords.push_back(stops_[stop_id].coordinates);
     } 
     double route_length = 0.0;
     for (size_t i = 0; i < stops_coords.size() - 1; ++i) {
@@ -102,9 +279,4 @@ double TransportCatalogue::CalculateGeoRouteLength(const Route& route) const {
     return route_length;
 }
     
-size_t TransportCatalogue::NearbyStopsHasher::operator()(std::pair<const Stop*, const Stop*> nearby_stops) const {
-    return static_cast<size_t>(37*std::hash<const void*>()(nearby_stops.first) + 
-                                  std::hash<const void*>()(nearby_stops.second));
-}    
-    
 } // namespace transport
@@ -1,7 +1,11 @@
 #pragma once
 
+#include "distance_table.h"
 #include "domain.h"
 #include "geo.h"
+#include "name_arena.h"
+#include "name_search_index.h"
+#include "spatial_index.h"
 
 #include <deque>
 #include <string>
@@ -13,12 +17,20 @@ namespace transport {
     
 class TransportCatalogue {
 public: 
-    void AddStop(const std::string& stop_name, const geo::Coordinates& stop_coorditanes);
+    void AddStop(std::string_view stop_name, const geo::Coordinates& stop_coorditanes);
+    // The distance is used for both directions until the opposite one is added too.
     void AddDistance(std::string_view stop_from, std::string_view stop_to, int distance);
-    void AddRoute(const std::string& route_name, const std::vector<std::string>& route_stops, bool is_roundtrip);  
+    void ReserveDistances(size_t distance_count);
+    // A route with the name of an existing one replaces it. The distances between its stops
+    // should be added before it.
+    void AddRoute(std::string_view route_name, const std::vector<std::string_view>& route_stops, bool is_roundtrip,
+                  std::vector<double> departure_times = {});  
+    void RemoveRoute(std::string_view route_name);
     const Stop* GetStop(std::string_view stop_name) const;
+    const Stop& GetStopById(StopId stop_id) const;
     const Route* GetRoute(std::string_view route_name) const;
     int GetDistance(std::string_view stop_from, std::string_view stop_to) const;
+    int GetDistance(StopId stop_from, StopId stop_to) const;
     
     struct RouteInfo {
         int number_of_stops;
@@ -27,27 +39,50 @@ public:
         double curvature;
     };
     
+    // The statistics are computed when the route is added and when a distance on it changes.
     RouteInfo GetRouteInfo(std::string_view route_name) const; 
     const std::unordered_set<std::string_view>* GetRoutesThroughStop(std::string_view stop_name) const;
     
+    // Indexes the coordinates of all stops added so far. The stops added later are found by
+    // a scan until the index is built again.
+    void BuildSpatialIndex();
+    // Pairs of the count nearest stops at most max_distance meters from the point and the
+    // distances, nearest first.
+    std::vector<std::pair<const Stop*, double>> FindNearestStops(const geo::Coordinates& point, size_t count,
+                                                                 double max_distance) const;
+    // Sorted by name. A box with min longitude greater than max longitude crosses the antimeridian.
+    std::vector<const Stop*> FindStopsInBox(const geo::Coordinates& min_corner, const geo::Coordinates& max_corner) const;
+    // Indexes the names of all stops and routes added so far. The names added later are
+    // checked one by one until the index is built again.
+    void BuildNameSearchIndex();
+    // Up to count stop and route names starting with the query, with typos, see NameSearchIndex.
+    std::vector<NameMatch> SearchNames(std::string_view query, size_t count) const;
+    
     const std::unordered_map<std::string_view, const Route*>& GetAllRoutes() const;
     const std::unordered_map<std::string_view, const Stop*>& GetAllStops() const;
      
 private:
+    // The view of an equal stop or route name if there is one, a new copy in the arena otherwise.
+    std::string_view InternName(std::string_view name);
+    RouteInfo CalculateRouteInfo(const Route& route) const;
     double CalculateGeoRouteLength(const Route& route) const;
     int CalculateRealRouteLength(const Route& route) const;
     
-    class NearbyStopsHasher {
-    public:
-        size_t operator()(std::pair<const Stop*, const Stop*> nearby_stops) const;
-    }; 
-    
+    // Every distinct stop and route name is stored once, the maps below are keyed by these views.
+    NameArena names_;
+    // Indexed by the ids. A deque keeps the addresses of the stops and routes.
     std::deque<Stop> stops_;
     std::deque<Route> routes_;
+    std::vector<RouteInfo> route_info_by_route_id_;
+    // Names are resolved to ids only here, everything else is keyed by the ids.
     std::unordered_map<std::string_view, const Stop*> stop_info_by_stop_name_;
     std::unordered_map<std::string_view, const Route*> route_info_by_route_name_;
-    std::unordered_map<std::string_view, std::unordered_set<std::string_view>> routes_through_stop_by_stop_name_;
-    std::unordered_map<std::pair<const Stop*, const Stop*>, int, NearbyStopsHasher> distances_between_stops_;    
+    std::vector<std::unordered_set<std::string_view>> routes_through_stop_by_stop_id_;
+    DistanceTable distances_between_stops_;
+    SpatialIndex stops_spatial_index_;
+    NameSearchIndex name_search_index_;
+    size_t name_indexed_stop_count_ = 0;
+    size_t name_indexed_route_count_ = 0;
 };
     
 } // namespace transport
@@ -1,52 +1,1159 @@
 #include "transport_router.h"
+#include "serialization.h"
 
+#include <algorithm>
 #include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <numeric>
 #include <stdexcept>
+#include <tuple>
+#include <type_traits>
 
 namespace transport {
+
+namespace {
+
+// Bump on any change of the cache file layout or of the way the graph is built.
+constexpr uint32_t CACHE_FORMAT_VERSION = 2;
+constexpr char CACHE_FILE_MAGIC[4] = {'T', 'C', 'R', 'T'};
+
+// Updates build the graph again once the free ride vertices or the removed edges of the
+// replaced routes exceed this share of the ones in use: removed edges keep their ids, and
+// the precomputed table grows with the square of the vertex count.
+constexpr double MAX_DEAD_SHARE = 0.25;
+
+size_t CountRideVertices(const Route& route) {
+    return route.is_roundtrip ? route.stops.size() : 2 * route.stops.size();
+}
+
+// The position of the cell (x, y) along the Hilbert curve filling the 2^16 x 2^16 grid.
+uint64_t ComputeHilbertIndex(uint32_t x, uint32_t y) {
+    constexpr uint32_t grid_size = 1u << 16;
+    uint64_t index = 0;
+    for (uint32_t half = grid_size / 2; half > 0; half /= 2) {
+        const uint32_t rx = (x & half) > 0 ? 1 : 0;
+        const uint32_t ry = (y & half) > 0 ? 1 : 0;
+        index += static_cast<uint64_t>(half) * half * ((3 * rx) ^ ry);
+        // Rotate the quadrant, so the curve inside it starts and ends where it should.
+        if (ry == 0) {
+            if (rx == 1) {
+                x = grid_size - 1 - x;
+                y = grid_size - 1 - y;
+            }
+            std::swap(x, y);
+        }
+    }
+    return index;
+}
+
+// Stable, so the stops sorted by name keep that order in the same cell.
+std::vector<const Stop*> OrderByHilbertCurve(std::vector<const Stop*> stops) {
+    if (stops.empty()) {
+        return stops;
+    }
+    const auto [min_lat, max_lat] = std::minmax_element(stops.begin(), stops.end(), [](const Stop* lhs, const Stop* rhs) {
+        return lhs->coordinates.lat < rhs->coordinates.lat;
+    });
+    const auto [min_lng, max_lng] = std::minmax_element(stops.begin(), stops.end(), [](const Stop* lhs, const Stop* rhs) {
+        return lhs->coordinates.lng < rhs->coordinates.lng;
+    });
+    const double lat_begin = (*min_lat)->coordinates.lat;
+    const double lng_begin = (*min_lng)->coordinates.lng;
+    const double lat_span = (*max_lat)->coordinates.lat - lat_begin;
+    const double lng_span = (*max_lng)->coordinates.lng - lng_begin;
+    const auto to_cell = [](double value, double begin, double span) {
+        constexpr double max_cell = (1u << 16) - 1;
+        return static_cast<uint32_t>(span > 0.0 ? std::round((value - begin) / span * max_cell) : 0.0);
+    };
+
+    std::vector<std::pair<uint64_t, const Stop*>> indexed_stops;
+    indexed_stops.reserve(stops.size());
+    for (const Stop* stop : stops) {
+        indexed_stops.push_back({ComputeHilbertIndex(to_cell(stop->coordinates.lng, lng_begin, lng_span),
+                                                     to_cell(stop->coordinates.lat, lat_begin, lat_span)),
+                                 stop});
+    }
+    std::stable_sort(indexed_stops.begin(), indexed_stops.end(), [](const auto& lhs, const auto& rhs) {
+        return lhs.first < rhs.first;
+    });
+    for (size_t index = 0; index < stops.size(); ++index) {
+        stops[index] = indexed_stops[index].second;
+    }
+    return stops;
+}
+
+// Stops are linked if they are consecutive on a route, in either direction. Every component
+// is searched from its stop of the smallest degree, the neighbours go by degree, and the
+// whole order is reversed. stops should be sorted by name, ties go by that order.
+std::vector<const Stop*> OrderByReverseCuthillMcKee(const TransportCatalogue& ctlg, std::vector<const Stop*> stops) {
+    std::vector<uint32_t> index_by_stop_id(stops.size());
+    for (uint32_t index = 0; index < stops.size(); ++index) {
+        index_by_stop_id[stops[index]->id] = index;
+    }
+    std::vector<std::vector<uint32_t>> neighbours(stops.size());
+    for (const auto [route_name, route_ptr] : ctlg.GetAllRoutes()) {
+        for (size_t index = 0; index + 1 < route_ptr->stops.size(); ++index) {
+            const uint32_t from = index_by_stop_id[route_ptr->stops[index]];
+            const uint32_t to = index_by_stop_id[route_ptr->stops[index + 1]];
+            if (from != to) {
+                neighbours[from].push_back(to);
+                neighbours[to].push_back(from);
+            }
+        }
+    }
+    for (auto& stop_neighbours : neighbours) {
+        std::sort(stop_neighbours.begin(), stop_neighbours.end());
+        stop_neighbours.erase(std::unique(stop_neighbours.begin(), stop_neighbours.end()), stop_neighbours.end());
+    }
+    const auto is_before = [&neighbours](uint32_t lhs, uint32_t rhs) {
+        return std::make_pair(neighbours[lhs].size(), lhs) < std::make_pair(neighbours[rhs].size(), rhs);
+    };
+    for (auto& stop_neighbours : neighbours) {
+        std::sort(stop_neighbours.begin(), stop_neighbours.end(), is_before);
+    }
+    std::vector<uint32_t> starts(stops.size());
+    for (uint32_t index = 0; index < stops.size(); ++index) {
+        starts[index] = index;
+    }
+    std::sort(starts.begin(), starts.end(), is_before);
+
+    std::vector<uint32_t> order;
+    order.reserve(stops.size());
+    std::vector<bool> is_visited(stops.size(), false);
+    for (const uint32_t start : starts) {
+        if (is_visited[start]) {
+            continue;
+        }
+        is_visited[start] = true;
+        order.push_back(start);
+        for (size_t head = order.size() - 1; head < order.size(); ++head) {
+            for (const uint32_t neighbour : neighbours[order[head]]) {
+                if (!is_visited[neighbour]) {
+                    is_visited[neighbour] = true;
+                    order.push_back(neighbour);
+                }
+            }
+        }
+    }
+    std::vector<const Stop*> ordered_stops;
+    ordered_stops.reserve(stops.size());
+    for (auto it = order.rbegin(); it != order.rend(); ++it) {
+        ordered_stops.push_back(stops[*it]);
+    }
+    return ordered_stops;
+}
+
+} // namespace
     
-void TransportRouter::SetSettings(RoutingSettings routing_settings) {
+template <typename Weight>
+void BasicTransportRouter<Weight>::SetSettings(RoutingSettings routing_settings) {
     routing_settings_ = routing_settings;
+    path_cache_.Reset(routing_settings_.path_cache_capacity);
+}
+
+template <typename Weight>
+void BasicTransportRouter<Weight>::UploadTransportData(const transport::TransportCatalogue& ctlg) {
+    path_cache_.Reset(routing_settings_.path_cache_capacity);
+    if (!thread_pool_) {
+        thread_pool_ = std::make_unique<concurrency::ThreadPool>();
+    }
+    if (routing_settings_.router_mode == RouterMode::RAPTOR) {
+        graph_data_ = {};
+        router_.reset();
+        pareto_router_.reset();
+        bounded_search_.reset();
+        static_graph_ = {};
+        raptor_router_ = std::make_unique<RaptorRouter>(ctlg, routing_settings_.bus_velocity, routing_settings_.bus_wait_time);
+        return;
+    }
+    raptor_router_.reset();
+    if (routing_settings_.cache_directory.empty()) {
+        BuildGraph(ctlg);
+        if (routing_settings_.prune_parallel_edges) {
+            PruneParallelEdges();
+        }
+        CreateRouter();
+        return;
+    }
+    const uint64_t cache_key = ComputeCacheKey(ctlg);
+    const std::string cache_file_path = GetCacheFilePath(cache_key);
+    if (LoadFromCacheFile(cache_file_path, cache_key, ctlg)) {
+        return;
+    }
+    BuildGraph(ctlg);
+    if (routing_settings_.prune_parallel_edges) {
+        PruneParallelEdges();
+    }
+    CreateRouter();
+    SaveToCacheFile(cache_file_path, cache_key);
 }
 
-void TransportRouter::UploadTransportData(const transport::TransportCatalogue& ctlg) {
-    graph_data_ = std::move(GraphAndItsTransportData<double>{graph::DirectedWeightedGraph<double>(ctlg.GetAllStops().size())});
-    AddVertexIdsInGraphData(ctlg.GetAllStops());
+template <typename Weight>
+void BasicTransportRouter<Weight>::BuildGraph(const transport::TransportCatalogue& ctlg) {
+    const size_t vertex_count = CountVerticesInGraph(ctlg);
+    graph_data_ = std::move(GraphAndItsTransportData<Weight>{graph::DirectedWeightedGraph<Weight>(vertex_count)});
+    AddVertexIdsInGraphData(GetStopsInVertexOrder(ctlg), vertex_count);
+    graph::VertexId next_ride_vertex_id = ctlg.GetAllStops().size();
+    std::vector<graph::VertexId> ride_vertex_ids;
     for (const auto [route_name, route_ptr] : ctlg.GetAllRoutes()) {
-        const auto& vec_stops = route_ptr->stops;
-        if (route_ptr->is_roundtrip) {
-            AddRouteInGraph(ctlg, vec_stops.begin(), vec_stops.size(), route_name);
+        const uint32_t bus_id = graph_data_.bus_name_by_bus_id.size();
+        graph_data_.bus_name_by_bus_id.push_back(route_name);
+        graph_data_.bus_id_by_bus_name[route_name] = bus_id;
+        graph_data_.edges_range_by_bus_id.emplace_back();
+        if (routing_settings_.graph_model == GraphModel::WAIT_RIDE) {
+            ride_vertex_ids.resize(CountRideVertices(*route_ptr));
+            std::iota(ride_vertex_ids.begin(), ride_vertex_ids.end(), next_ride_vertex_id);
+            next_ride_vertex_id += ride_vertex_ids.size();
+        }
+        AddBusInGraph(ctlg, *route_ptr, bus_id, ride_vertex_ids);
+    }
+}
+
+// In the wait/ride model ride_vertex_ids has a vertex for every stop of the route in each
+// direction, the forward ones first.
+template <typename Weight>
+void BasicTransportRouter<Weight>::AddBusInGraph(const transport::TransportCatalogue& ctlg, const Route& route, uint32_t bus_id,
+                                                 const std::vector<graph::VertexId>& ride_vertex_ids) {
+    const auto& vec_stops = route.stops;
+    const std::vector<graph::VertexId> ids_stops = GetStopVertexIds(vec_stops);
+    const graph::EdgeId first_edge_id = graph_data_.graph.GetEdgeCount();
+    if (routing_settings_.graph_model == GraphModel::WAIT_RIDE) {
+        AddRouteWithRideVerticesInGraph(ctlg, vec_stops.begin(), vec_stops.size(), ids_stops.begin(), ride_vertex_ids.begin(), bus_id);
+        if (!route.is_roundtrip) {
+            AddRouteWithRideVerticesInGraph(ctlg, vec_stops.rbegin(), vec_stops.size(), ids_stops.rbegin(),
+                                            ride_vertex_ids.begin() + vec_stops.size(), bus_id);
+        }
+    } else if (route.is_roundtrip) {
+        AddRouteInGraph(ctlg, vec_stops.begin(), vec_stops.size(), ids_stops.begin(), bus_id);
+    } else {
+        AddRouteInGraph(ctlg, vec_stops.begin(), vec_stops.size(), ids_stops.begin(), bus_id);
+        AddRouteInGraph(ctlg, vec_stops.rbegin(), vec_stops.size(), ids_stops.rbegin(), bus_id);            
+    }
+    graph_data_.edges_range_by_bus_id[bus_id] = {first_edge_id, graph_data_.graph.GetEdgeCount()};
+}
+
+template <typename Weight>
+void BasicTransportRouter<Weight>::UpdateRoute(const transport::TransportCatalogue& ctlg, std::string_view route_name) {
+    UpdateRoutes(ctlg, {route_name});
+}
+
+// Both directions of the road may change, see TransportCatalogue::AddDistance.
+template <typename Weight>
+void BasicTransportRouter<Weight>::UpdateDistance(const transport::TransportCatalogue& ctlg, std::string_view stop_from,
+                                                  std::string_view stop_to) {
+    std::vector<std::string_view> route_names;
+    const Stop* from = ctlg.GetStop(stop_from);
+    const Stop* to = ctlg.GetStop(stop_to);
+    const auto* routes_through_stop = ctlg.GetRoutesThroughStop(stop_from);
+    if (from && to && routes_through_stop) {
+        for (const std::string_view route_name : *routes_through_stop) {
+            const auto& stops = ctlg.GetRoute(route_name)->stops;
+            for (size_t index = 0; index + 1 < stops.size(); ++index) {
+                if ((stops[index] == from->id && stops[index + 1] == to->id)
+                    || (stops[index] == to->id && stops[index + 1] == from->id)) {
+                    route_names.push_back(route_name);
+                    break;
+                }
+            }
+        }
+    }
+    UpdateRoutes(ctlg, route_names);
+}
+
+// The edges of every given bus are removed from the graph and the edges of its current
+// route are appended. The route takes the ride vertices of the bus first, then the free
+// ones, and only then new ones; the ride vertices it does not need become free. Removed
+// edges keep their ids, so the graph is built again once too many of them pile up.
+template <typename Weight>
+void BasicTransportRouter<Weight>::UpdateRoutes(const transport::TransportCatalogue& ctlg, const std::vector<std::string_view>& route_names) {
+    const auto has_all_stops = [this](const Route* route) {
+        return std::all_of(route->stops.begin(), route->stops.end(), [this](StopId stop_id) {
+            return stop_id < graph_data_.vertex_id_by_stop_id.size();
+        });
+    };
+    const bool is_stops_changed = std::any_of(route_names.begin(), route_names.end(), [&](std::string_view route_name) {
+        const Route* route = ctlg.GetRoute(route_name);
+        return route && !has_all_stops(route);
+    });
+    // A new stop would change the numbering of the vertices, so everything is built again.
+    if (!router_ || is_stops_changed || ctlg.GetAllStops().size() != graph_data_.stop_name_by_vertex_id.size()) {
+        UploadTransportData(ctlg);
+        return;
+    }
+    path_cache_.Reset(routing_settings_.path_cache_capacity);
+
+    auto& graph = graph_data_.graph;
+    const size_t stop_count = graph_data_.stop_name_by_vertex_id.size();
+    std::vector<graph::EdgeId> removed_edges;
+    std::vector<graph::EdgeId> added_edges;
+    std::vector<graph::VertexId> ride_vertex_ids;
+    for (const std::string_view route_name : route_names) {
+        std::optional<uint32_t> bus_id;
+        ride_vertex_ids.clear();
+        if (const auto it = graph_data_.bus_id_by_bus_name.find(route_name); it != graph_data_.bus_id_by_bus_name.end()) {
+            bus_id = it->second;
+            graph_data_.bus_id_by_bus_name.erase(it);
+            auto& [first_edge_id, last_edge_id] = graph_data_.edges_range_by_bus_id[*bus_id];
+            for (graph::EdgeId edge_id = first_edge_id; edge_id < last_edge_id; ++edge_id) {
+                // The boarding edges lead to the ride vertices of the bus in the order they were given.
+                if (routing_settings_.graph_model == GraphModel::WAIT_RIDE && graph.GetEdge(edge_id).from < stop_count) {
+                    ride_vertex_ids.push_back(graph.GetEdge(edge_id).to);
+                }
+                graph.RemoveEdge(edge_id);
+                removed_edges.push_back(edge_id);
+            }
+            graph_data_.dead_edge_count += last_edge_id - first_edge_id;
+            first_edge_id = last_edge_id;
+        }
+
+        const Route* route = ctlg.GetRoute(route_name);
+        const size_t ride_vertex_count = route && routing_settings_.graph_model == GraphModel::WAIT_RIDE
+                                         ? CountRideVertices(*route) : 0;
+        auto& free_ride_vertices = graph_data_.free_ride_vertices;
+        while (ride_vertex_ids.size() > ride_vertex_count) {
+            free_ride_vertices.push_back(ride_vertex_ids.back());
+            ride_vertex_ids.pop_back();
+        }
+        while (ride_vertex_ids.size() < ride_vertex_count) {
+            if (free_ride_vertices.empty()) {
+                ride_vertex_ids.push_back(graph.AddVertex());
+            } else {
+                ride_vertex_ids.push_back(free_ride_vertices.back());
+                free_ride_vertices.pop_back();
+            }
+        }
+        if (!route) {
+            continue;
+        }
+        if (!bus_id) {
+            bus_id = graph_data_.bus_name_by_bus_id.size();
+            graph_data_.bus_name_by_bus_id.emplace_back();
+            graph_data_.edges_range_by_bus_id.emplace_back();
+        }
+        graph_data_.bus_name_by_bus_id[*bus_id] = route->name;
+        graph_data_.bus_id_by_bus_name[route->name] = *bus_id;
+
+        graph_data_.coordinates_by_vertex_id.resize(graph.GetVertexCount());
+        AddBusInGraph(ctlg, *route, *bus_id, ride_vertex_ids);
+        const auto [first_edge_id, last_edge_id] = graph_data_.edges_range_by_bus_id[*bus_id];
+        for (graph::EdgeId edge_id = first_edge_id; edge_id < last_edge_id; ++edge_id) {
+            added_edges.push_back(edge_id);
+        }
+    }
+
+    const size_t dead_vertex_count = graph_data_.free_ride_vertices.size();
+    const size_t dead_edge_count = graph_data_.dead_edge_count;
+    if (dead_vertex_count > MAX_DEAD_SHARE * (graph.GetVertexCount() - dead_vertex_count)
+        || dead_edge_count > MAX_DEAD_SHARE * (graph.GetEdgeCount() - dead_edge_count)) {
+        UploadTransportData(ctlg);
+        return;
+    }
+    if (routing_settings_.prune_parallel_edges) {
+        PruneParallelEdges(removed_edges, added_edges);
+    }
+    if (router_->UpdateEdges(removed_edges, added_edges)) {
+        CreateGraphSearches();
+    } else {
+        CreateRouter();
+    }
+}
+
+// Of the edges between the same two vertices only the lightest one, the first of equally
+// light ones, can be on a shortest path. Parallel edges come from the routes sharing
+// a corridor, so a stop-to-stop graph loses many of its edges. The wait/ride graph has
+// no parallel edges. The dropped edges keep their ids and ride data.
+template <typename Weight>
+void BasicTransportRouter<Weight>::PruneParallelEdges() {
+    auto& graph = graph_data_.graph;
+    std::vector<bool> is_pruned(graph.GetEdgeCount(), false);
+    std::vector<graph::EdgeId> edges;
+    for (graph::VertexId vertex = 0; vertex < graph.GetVertexCount(); ++vertex) {
+        const auto incident_edges = graph.GetIncidentEdges(vertex);
+        edges.assign(incident_edges.begin(), incident_edges.end());
+        std::sort(edges.begin(), edges.end(), [&graph](graph::EdgeId lhs, graph::EdgeId rhs) {
+            return std::tie(graph.GetEdge(lhs).to, graph.GetEdge(lhs).weight, lhs)
+                   < std::tie(graph.GetEdge(rhs).to, graph.GetEdge(rhs).weight, rhs);
+        });
+        bool has_pruned = false;
+        for (size_t index = 1; index < edges.size(); ++index) {
+            const graph::VertexId to = graph.GetEdge(edges[index]).to;
+            if (to == graph.GetEdge(edges[index - 1]).to) {
+                is_pruned[edges[index]] = true;
+                graph_data_.pruned_edges_by_vertices[{vertex, to}].push_back(edges[index]);
+                has_pruned = true;
+            }
+        }
+        if (has_pruned) {
+            graph.RemoveIncidentEdgesIf(vertex, [&is_pruned](graph::EdgeId edge_id) {
+                return is_pruned[edge_id];
+            });
+        }
+    }
+}
+
+// Prunes again the vertex pairs of the edges changed by an update: a pruned edge comes
+// back if it is now the lightest one, an added edge is dropped if a parallel one is not
+// heavier. removed_edges and added_edges are corrected for the router.
+template <typename Weight>
+void BasicTransportRouter<Weight>::PruneParallelEdges(std::vector<graph::EdgeId>& removed_edges,
+                                                      std::vector<graph::EdgeId>& added_edges) {
+    auto& graph = graph_data_.graph;
+    std::vector<std::pair<graph::VertexId, graph::VertexId>> vertex_pairs;
+    for (const auto* changed_edges : {&removed_edges, &added_edges}) {
+        for (const graph::EdgeId edge_id : *changed_edges) {
+            vertex_pairs.push_back({graph.GetEdge(edge_id).from, graph.GetEdge(edge_id).to});
+        }
+    }
+    std::sort(vertex_pairs.begin(), vertex_pairs.end());
+    vertex_pairs.erase(std::unique(vertex_pairs.begin(), vertex_pairs.end()), vertex_pairs.end());
+
+    std::vector<graph::EdgeId> newly_pruned_edges;
+    std::vector<graph::EdgeId> restored_edges;
+    for (const auto& [from, to] : vertex_pairs) {
+        std::vector<graph::EdgeId> edges;
+        for (const graph::EdgeId edge_id : graph.GetIncidentEdges(from)) {
+            if (graph.GetEdge(edge_id).to == to) {
+                edges.push_back(edge_id);
+            }
+        }
+        const size_t in_graph_count = edges.size();
+        const auto pruned_it = graph_data_.pruned_edges_by_vertices.find({from, to});
+        if (pruned_it != graph_data_.pruned_edges_by_vertices.end()) {
+            for (const graph::EdgeId edge_id : pruned_it->second) {
+                if (IsEdgeOfCurrentRoute(edge_id)) {
+                    edges.push_back(edge_id);
+                }
+            }
+        }
+        if (edges.empty()) {
+            if (pruned_it != graph_data_.pruned_edges_by_vertices.end()) {
+                graph_data_.pruned_edges_by_vertices.erase(pruned_it);
+            }
+            continue;
+        }
+
+        const auto lightest_it = std::min_element(edges.begin(), edges.end(), [&graph](graph::EdgeId lhs, graph::EdgeId rhs) {
+            return std::tie(graph.GetEdge(lhs).weight, lhs) < std::tie(graph.GetEdge(rhs).weight, rhs);
+        });
+        if (static_cast<size_t>(lightest_it - edges.begin()) >= in_graph_count) {
+            graph.RestoreEdge(*lightest_it);
+            restored_edges.push_back(*lightest_it);
+        }
+        for (size_t index = 0; index < in_graph_count; ++index) {
+            if (edges[index] != *lightest_it) {
+                graph.RemoveEdge(edges[index]);
+                newly_pruned_edges.push_back(edges[index]);
+            }
+        }
+        edges.erase(lightest_it);
+        if (edges.empty()) {
+            graph_data_.pruned_edges_by_vertices.erase({from, to});
         } else {
-            AddRouteInGraph(ctlg, vec_stops.begin(), vec_stops.size(), route_name);
-            AddRouteInGraph(ctlg, vec_stops.rbegin(), vec_stops.size(), route_name);            
+            graph_data_.pruned_edges_by_vertices[{from, to}] = std::move(edges);
+        }
+    }
+
+    // An added edge pruned right away was never seen by the router.
+    std::sort(newly_pruned_edges.begin(), newly_pruned_edges.end());
+    const auto is_newly_pruned = [&newly_pruned_edges](graph::EdgeId edge_id) {
+        return std::binary_search(newly_pruned_edges.begin(), newly_pruned_edges.end(), edge_id);
+    };
+    std::vector<graph::EdgeId> sorted_added_edges = added_edges;
+    std::sort(sorted_added_edges.begin(), sorted_added_edges.end());
+    for (const graph::EdgeId edge_id : newly_pruned_edges) {
+        if (!std::binary_search(sorted_added_edges.begin(), sorted_added_edges.end(), edge_id)) {
+            removed_edges.push_back(edge_id);
         }
     }
-    router_ = std::make_unique<graph::Router<double>>(graph_data_.graph);
+    added_edges.erase(std::remove_if(added_edges.begin(), added_edges.end(), is_newly_pruned), added_edges.end());
+    added_edges.insert(added_edges.end(), restored_edges.begin(), restored_edges.end());
+}
+
+// Edges of a replaced or removed route keep their ids but are out of the range of their bus.
+template <typename Weight>
+bool BasicTransportRouter<Weight>::IsEdgeOfCurrentRoute(graph::EdgeId edge_id) const {
+    const auto [first_edge_id, last_edge_id] = graph_data_.edges_range_by_bus_id[graph_data_.edges_ride_data.bus_ids[edge_id]];
+    return first_edge_id <= edge_id && edge_id < last_edge_id;
+}
+
+template <typename Weight>
+size_t BasicTransportRouter<Weight>::GetPrunedEdgeCount() const {
+    size_t pruned_edge_count = 0;
+    for (const auto& [vertices, edges] : graph_data_.pruned_edges_by_vertices) {
+        pruned_edge_count += edges.size();
+    }
+    return pruned_edge_count;
+}
+
+template <typename Weight>
+void BasicTransportRouter<Weight>::CreateRouter() {
+    if (routing_settings_.router_mode == RouterMode::ON_DEMAND) {
+        router_ = std::make_unique<graph::DijkstraRouter<Weight>>(graph_data_.graph);
+    } else if (routing_settings_.router_mode == RouterMode::CONTRACTION_HIERARCHY) {
+        router_ = std::make_unique<graph::ContractionHierarchyRouter<Weight>>(graph_data_.graph);
+    } else if (routing_settings_.router_mode == RouterMode::LANDMARKS) {
+        router_ = std::make_unique<graph::AltRouter<Weight>>(graph_data_.graph, routing_settings_.landmark_count,
+                                                             graph_data_.coordinates_by_vertex_id);
+    } else {
+        router_ = std::make_unique<graph::Router<Weight>>(graph_data_.graph);
+    }
+    CreateGraphSearches();
+}
+
+// The searches are created after the graph they refer to is replaced.
+template <typename Weight>
+void BasicTransportRouter<Weight>::CreateGraphSearches() {
+    static_graph_ = graph::StaticGraph<Weight>(graph_data_.graph);
+    pareto_router_ = std::make_unique<graph::ParetoRouter<Weight>>(static_graph_);
+    bounded_search_ = std::make_unique<graph::BoundedSearch<Weight>>(static_graph_);
 }
 
-std::optional<PathInfo> TransportRouter::BuildPath(std::string_view stop_from, std::string_view stop_to) const {
+template <typename Weight>
+std::optional<graph::VertexId> BasicTransportRouter<Weight>::GetStopVertexId(std::string_view stop_name) const {
+    const auto it = graph_data_.vertex_id_by_stop_name.find(stop_name);
+    if (it == graph_data_.vertex_id_by_stop_name.end()) {
+        return std::nullopt;
+    }
+    return it->second;
+}
+
+template <typename Weight>
+std::optional<PathInfo> BasicTransportRouter<Weight>::BuildPath(std::string_view stop_from, std::string_view stop_to,
+                                                                double departure_time) const {
+    if (raptor_router_) {
+        return ComputeTimetablePath(stop_from, stop_to, departure_time);
+    }
+    if (!router_) {
+        return std::nullopt;
+    }        
+    return BuildPath(graph_data_.vertex_id_by_stop_name.at(stop_from), graph_data_.vertex_id_by_stop_name.at(stop_to));
+}
+
+template <typename Weight>
+std::optional<PathInfo> BasicTransportRouter<Weight>::BuildPath(graph::VertexId stop_from_id, graph::VertexId stop_to_id) const {
     if (!router_) {
         return std::nullopt;
     }        
-    const auto route_info = router_->BuildRoute(graph_data_.vertex_id_by_stop_name.at(stop_from), 
-                                                graph_data_.vertex_id_by_stop_name.at(stop_to));
-    if (!route_info) {
-        return std::nullopt;   
+    if (routing_settings_.path_cache_capacity > 0) {
+        if (auto cached_path = path_cache_.Get({stop_from_id, stop_to_id})) {
+            return std::move(*cached_path);
+        }
+    }
+    std::optional<PathInfo> path = PathInfo{};
+    if (!ComputePath(stop_from_id, stop_to_id, *path)) {
+        path.reset();
+    }
+    if (routing_settings_.path_cache_capacity > 0) {
+        path_cache_.Put({stop_from_id, stop_to_id}, path);
+    }
+    return path;
+}
+
+template <typename Weight>
+bool BasicTransportRouter<Weight>::FillPath(graph::VertexId stop_from_id, graph::VertexId stop_to_id, PathInfo& path_info) const {
+    if (!router_) {
+        return false;
+    }
+    if (routing_settings_.path_cache_capacity > 0) {
+        auto path = BuildPath(stop_from_id, stop_to_id);
+        if (!path) {
+            return false;
+        }
+        path_info = std::move(*path);
+        return true;
+    }
+    return ComputePath(stop_from_id, stop_to_id, path_info);
+}
+
+template <typename Weight>
+bool BasicTransportRouter<Weight>::FillPath(std::string_view stop_from, std::string_view stop_to, double departure_time,
+                                            PathInfo& path_info) const {
+    if (raptor_router_) {
+        auto path = ComputeTimetablePath(stop_from, stop_to, departure_time);
+        if (!path) {
+            return false;
+        }
+        path_info = std::move(*path);
+        return true;
+    }
+    if (!router_) {
+        return false;
+    }
+    return FillPath(graph_data_.vertex_id_by_stop_name.at(stop_from), graph_data_.vertex_id_by_stop_name.at(stop_to), path_info);
+}
+
+template <typename Weight>
+cache::CacheStats BasicTransportRouter<Weight>::GetPathCacheStats() const {
+    return path_cache_.GetStats();
+}
+
+template <typename Weight>
+std::optional<TimeMatrix> BasicTransportRouter<Weight>::BuildTimeMatrix(const std::vector<std::string_view>& stops_from,
+                                                                       const std::vector<std::string_view>& stops_to,
+                                                                       double departure_time) const {
+    if (raptor_router_) {
+        return BuildTimetableTimeMatrix(stops_from, stops_to, departure_time);
+    }
+    if (!router_) {
+        return std::nullopt;
+    }
+    std::vector<graph::VertexId> ids_from;
+    std::vector<graph::VertexId> ids_to;
+    ids_from.reserve(stops_from.size());
+    ids_to.reserve(stops_to.size());
+    for (const std::string_view stop_name : stops_from) {
+        const auto id = GetStopVertexId(stop_name);
+        if (!id) {
+            return std::nullopt;
+        }
+        ids_from.push_back(*id);
+    }
+    for (const std::string_view stop_name : stops_to) {
+        const auto id = GetStopVertexId(stop_name);
+        if (!id) {
+            return std::nullopt;
+        }
+        ids_to.push_back(*id);
+    }
+    auto weight_matrix = router_->BuildWeightMatrix(ids_from, ids_to, *thread_pool_);
+    if constexpr (std::is_same_v<Weight, double>) {
+        return weight_matrix;
+    } else {
+        TimeMatrix time_matrix(weight_matrix.size());
+        for (size_t row = 0; row < weight_matrix.size(); ++row) {
+            time_matrix[row].reserve(weight_matrix[row].size());
+            for (const auto& weight : weight_matrix[row]) {
+                time_matrix[row].push_back(weight ? std::optional<double>(ToMinutes(*weight)) : std::nullopt);
+            }
+        }
+        return time_matrix;
+    }
+}
+
+// The edges of the route go to a buffer of the calling thread, which keeps its memory
+// between the queries.
+template <typename Weight>
+bool BasicTransportRouter<Weight>::ComputePath(graph::VertexId stop_from_id, graph::VertexId stop_to_id, PathInfo& path_info) const {
+    thread_local typename graph::RouterBase<Weight>::RouteInfo route_info{Weight{}, {}};
+    if (!router_->FillRoute(stop_from_id, stop_to_id, route_info)) {
+        return false;
+    }
+    FillPathInfo(route_info.weight, route_info.edges, path_info);
+    return true;
+}
+
+template <typename Weight>
+std::vector<PathInfo> BasicTransportRouter<Weight>::BuildParetoPaths(std::string_view stop_from, std::string_view stop_to,
+                                                                     double departure_time) const {
+    std::vector<PathInfo> paths;
+    if (raptor_router_) {
+        const auto journeys = raptor_router_->BuildJourneys(stop_from, stop_to, departure_time);
+        for (auto it = journeys.rbegin(); it != journeys.rend(); ++it) {
+            paths.push_back(MakePathInfo(*it, departure_time));
+        }
+        return paths;
+    }
+    if (!router_) {
+        return paths;
+    }
+    // A ride starts on every ride edge of the stop-to-stop model and on every boarding
+    // edge of the wait/ride model, the boarding edges are the ones leaving stop vertices.
+    const EdgesRideData& rides = graph_data_.edges_ride_data;
+    const size_t stop_count = graph_data_.stop_name_by_vertex_id.size();
+    const bool is_wait_ride = routing_settings_.graph_model == GraphModel::WAIT_RIDE;
+    const auto count_rides = [&](graph::EdgeId edge_id) -> uint32_t {
+        if (is_wait_ride) {
+            return rides.span_counts[edge_id] == 0 && graph_data_.graph.GetEdge(edge_id).from < stop_count;
+        }
+        return rides.span_counts[edge_id] > 0;
+    };
+    const auto routes = pareto_router_->BuildRoutes(graph_data_.vertex_id_by_stop_name.at(stop_from),
+                                                    graph_data_.vertex_id_by_stop_name.at(stop_to), count_rides);
+    paths.reserve(routes.size());
+    for (const auto& route : routes) {
+        FillPathInfo(route.weight, route.edges, paths.emplace_back());
+    }
+    return paths;
+}
+
+template <typename Weight>
+std::vector<ReachableStop> BasicTransportRouter<Weight>::FindReachableStops(std::string_view stop_from, double max_time,
+                                                                           double departure_time) const {
+    std::vector<ReachableStop> reachable_stops;
+    if (raptor_router_) {
+        for (const auto& [stop_name, arrival_time] : raptor_router_->FindReachableStops(stop_from, departure_time, max_time)) {
+            reachable_stops.push_back({stop_name, arrival_time - departure_time});
+        }
+    } else if (router_) {
+        // Ride vertices of the wait/ride model are searched through but not reported.
+        const size_t stop_count = graph_data_.stop_name_by_vertex_id.size();
+        const auto reachable_vertices = bounded_search_->FindReachable(graph_data_.vertex_id_by_stop_name.at(stop_from),
+                                                                       ToWeight(max_time));
+        for (const auto& [vertex_id, weight] : reachable_vertices) {
+            if (vertex_id < stop_count) {
+                reachable_stops.push_back({graph_data_.stop_name_by_vertex_id[vertex_id], ToMinutes(weight)});
+            }
+        }
+    }
+    std::sort(reachable_stops.begin(), reachable_stops.end(), [](const ReachableStop& lhs, const ReachableStop& rhs) {
+        return std::tie(lhs.time, lhs.stop_name) < std::tie(rhs.time, rhs.stop_name);
+    });
+    return reachable_stops;
+}
+
+// The items are written over path_info.items, keeping its memory.
+template <typename Weight>
+void BasicTransportRouter<Weight>::FillPathInfo(Weight weight, const std::vector<graph::EdgeId>& edges, PathInfo& path_info) const {
+    const EdgesRideData& rides = graph_data_.edges_ride_data;
+    const double ride_weight_shift = routing_settings_.graph_model == GraphModel::STOP_TO_STOP
+                                     ? routing_settings_.bus_wait_time : 0.0;
+    std::vector<EdgeInfo>& items = path_info.items;
+    items.clear();
+    bool is_ride_continued = false;
+    for (graph::EdgeId edge_id : edges) {
+        if (rides.span_counts[edge_id] == 0) {
+            is_ride_continued = false;
+            continue;
+        }
+        const double ride_weight = ToMinutes(graph_data_.graph.GetEdge(edge_id).weight) - ride_weight_shift;
+        const std::string_view finish_stop = graph_data_.stop_name_by_vertex_id[rides.finish_stop_ids[edge_id]];
+        if (is_ride_continued) {
+            items.back().weight += ride_weight;
+            items.back().span_count += rides.span_counts[edge_id];
+            items.back().finish_stop = finish_stop;
+        } else {
+            items.push_back({ride_weight,
+                             graph_data_.bus_name_by_bus_id[rides.bus_ids[edge_id]],
+                             static_cast<int>(rides.span_counts[edge_id]),
+                             graph_data_.stop_name_by_vertex_id[rides.start_stop_ids[edge_id]],
+                             finish_stop,
+                             static_cast<double>(routing_settings_.bus_wait_time)});
+            if (routing_settings_.keep_edge_alternatives) {
+                AddAlternativeBuses(edge_id, items.back().alternative_buses);
+            }
+        }
+        is_ride_continued = routing_settings_.graph_model == GraphModel::WAIT_RIDE;
+    }
+    path_info.total_time = ToMinutes(weight);
+}
+
+// The buses of the pruned edges parallel to the edge and as light as it, each bus once.
+template <typename Weight>
+void BasicTransportRouter<Weight>::AddAlternativeBuses(graph::EdgeId edge_id, std::vector<std::string_view>& bus_names) const {
+    const auto& edge = graph_data_.graph.GetEdge(edge_id);
+    const auto it = graph_data_.pruned_edges_by_vertices.find({edge.from, edge.to});
+    if (it == graph_data_.pruned_edges_by_vertices.end()) {
+        return;
+    }
+    const uint32_t bus_id = graph_data_.edges_ride_data.bus_ids[edge_id];
+    for (const graph::EdgeId pruned_edge_id : it->second) {
+        const uint32_t pruned_bus_id = graph_data_.edges_ride_data.bus_ids[pruned_edge_id];
+        const std::string_view bus_name = graph_data_.bus_name_by_bus_id[pruned_bus_id];
+        if (pruned_bus_id != bus_id && !(edge.weight < graph_data_.graph.GetEdge(pruned_edge_id).weight)
+            && std::find(bus_names.begin(), bus_names.end(), bus_name) == bus_names.end()) {
+            bus_names.push_back(bus_name);
+        }
+    }
+}
+
+template <typename Weight>
+std::optional<PathInfo> BasicTransportRouter<Weight>::ComputeTimetablePath(std::string_view stop_from, std::string_view stop_to,
+                                                                           double departure_time) const {
+    const auto journey = raptor_router_->BuildJourney(stop_from, stop_to, departure_time);
+    if (!journey) {
+        return std::nullopt;
+    }
+    return MakePathInfo(*journey, departure_time);
+}
+
+template <typename Weight>
+PathInfo BasicTransportRouter<Weight>::MakePathInfo(const RaptorRouter::Journey& journey, double departure_time) const {
+    std::vector<EdgeInfo> items;
+    items.reserve(journey.legs.size());
+    for (const auto& leg : journey.legs) {
+        items.push_back({leg.ride_time, leg.bus_name, leg.span_count, leg.start_stop, leg.finish_stop, leg.wait_time});
+    }
+    return PathInfo{std::move(items), journey.arrival_time - departure_time};
+}
+
+// Every row is a separate search, the rows are computed in parallel.
+template <typename Weight>
+std::optional<TimeMatrix> BasicTransportRouter<Weight>::BuildTimetableTimeMatrix(const std::vector<std::string_view>& stops_from,
+                                                                                 const std::vector<std::string_view>& stops_to,
+                                                                                 double departure_time) const {
+    const auto has_stop = [this](std::string_view stop_name) {
+        return raptor_router_->HasStop(stop_name);
+    };
+    if (!std::all_of(stops_from.begin(), stops_from.end(), has_stop) || !std::all_of(stops_to.begin(), stops_to.end(), has_stop)) {
+        return std::nullopt;
+    }
+    TimeMatrix time_matrix(stops_from.size());
+    thread_pool_->ParallelFor(stops_from.size(), [&](size_t row) {
+        time_matrix[row] = raptor_router_->ComputeArrivalTimes(stops_from[row], stops_to, departure_time);
+    });
+    for (auto& time_row : time_matrix) {
+        for (auto& time : time_row) {
+            if (time) {
+                *time -= departure_time;
+            }
+        }
+    }
+    return time_matrix;
+}
+
+// The key covers everything the graph and the routes table are built from: the stops,
+// the routes with the distances along them and the settings used by the builder.
+template <typename Weight>
+uint64_t BasicTransportRouter<Weight>::ComputeCacheKey(const transport::TransportCatalogue& ctlg) const {
+    serialization::ContentHasher hasher;
+    hasher.AddValue(CACHE_FORMAT_VERSION);
+    hasher.AddValue(static_cast<uint32_t>(sizeof(Weight)));
+    hasher.AddValue(std::is_floating_point_v<Weight>);
+    hasher.AddValue(routing_settings_.bus_velocity);
+    hasher.AddValue(routing_settings_.bus_wait_time);
+    hasher.AddValue(static_cast<uint32_t>(routing_settings_.router_mode));
+    hasher.AddValue(static_cast<uint32_t>(routing_settings_.graph_model));
+    hasher.AddValue(routing_settings_.prune_parallel_edges);
+    hasher.AddValue(static_cast<uint32_t>(routing_settings_.vertex_order));
+
+    std::vector<const Stop*> stops;
+    stops.reserve(ctlg.GetAllStops().size());
+    for (const auto [stop_name, stop_ptr] : ctlg.GetAllStops()) {
+        stops.push_back(stop_ptr);
+    }
+    std::sort(stops.begin(), stops.end(), [](const Stop* lhs, const Stop* rhs) {
+        return lhs->name < rhs->name;
+    });
+    hasher.AddValue(static_cast<uint64_t>(stops.size()));
+    for (const Stop* stop : stops) {
+        hasher.AddString(stop->name);
+        hasher.AddValue(stop->coordinates.lat);
+        hasher.AddValue(stop->coordinates.lng);
+    }
+
+    std::vector<const Route*> routes;
+    routes.reserve(ctlg.GetAllRoutes().size());
+    for (const auto [route_name, route_ptr] : ctlg.GetAllRoutes()) {
+        routes.push_back(route_ptr);
+    }
+    std::sort(routes.begin(), routes.end(), [](const Route* lhs, const Route* rhs) {
+        return lhs->name < rhs->name;
+    });
+    hasher.AddValue(static_cast<uint64_t>(routes.size()));
+    for (const Route* route : routes) {
+        hasher.AddString(route->name);
+        hasher.AddValue(route->is_roundtrip);
+        hasher.AddValue(static_cast<uint64_t>(route->stops.size()));
+        for (size_t index = 0; index < route->stops.size(); ++index) {
+            hasher.AddString(ctlg.GetStopById(route->stops[index]).name);
+            if (index + 1 < route->stops.size()) {
+                hasher.AddValue(ctlg.GetDistance(route->stops[index], route->stops[index + 1]));
+                if (!route->is_roundtrip) {
+                    hasher.AddValue(ctlg.GetDistance(route->stops[index + 1], route->stops[index]));
+                }
+            }
+        }
+    }
+    return hasher.GetHash();
+}
+
+template <typename Weight>
+std::string BasicTransportRouter<Weight>::GetCacheFilePath(uint64_t cache_key) const {
+    char file_name[32];
+    std::snprintf(file_name, sizeof(file_name), "router_%016llx.bin", static_cast<unsigned long long>(cache_key));
+    return (std::filesystem::path(routing_settings_.cache_directory) / file_name).string();
+}
+
+// Any mismatch or damage of the file means a cache miss, graph_data_ and router_ are
+// changed only when the whole file is read and checked.
+template <typename Weight>
+bool BasicTransportRouter<Weight>::LoadFromCacheFile(const std::string& file_path, uint64_t cache_key,
+                                                     const transport::TransportCatalogue& ctlg) {
+    std::ifstream input(file_path, std::ios::binary);
+    if (!input) {
+        return false;
+    }
+    std::error_code error;
+    const uint64_t file_size = std::filesystem::file_size(file_path, error);
+    if (error) {
+        return false;
+    }
+
+    char magic[sizeof(CACHE_FILE_MAGIC)];
+    uint32_t format_version = 0;
+    uint64_t file_cache_key = 0;
+    if (!input.read(magic, sizeof(magic)) || !std::equal(magic, magic + sizeof(magic), CACHE_FILE_MAGIC)
+        || !serialization::ReadValue(input, format_version) || format_version != CACHE_FORMAT_VERSION
+        || !serialization::ReadValue(input, file_cache_key) || file_cache_key != cache_key) {
+        return false;
+    }
+
+    GraphAndItsTransportData<Weight> graph_data;
+    uint64_t stop_count = 0;
+    if (!serialization::ReadValue(input, stop_count) || stop_count != ctlg.GetAllStops().size()) {
+        return false;
+    }
+    std::string name;
+    for (graph::VertexId vertex_id = 0; vertex_id < stop_count; ++vertex_id) {
+        const Stop* stop = serialization::ReadString(input, name, file_size) ? ctlg.GetStop(name) : nullptr;
+        if (!stop || graph_data.vertex_id_by_stop_name.count(stop->name)) {
+            return false;
+        }
+        graph_data.vertex_id_by_stop_name[stop->name] = vertex_id;
+        graph_data.stop_name_by_vertex_id.push_back(stop->name);
+    }
+    graph_data.vertex_id_by_stop_id.resize(stop_count);
+    for (graph::VertexId vertex_id = 0; vertex_id < stop_count; ++vertex_id) {
+        graph_data.vertex_id_by_stop_id[ctlg.GetStop(graph_data.stop_name_by_vertex_id[vertex_id])->id] = vertex_id;
+    }
+    uint64_t bus_count = 0;
+    if (!serialization::ReadValue(input, bus_count) || bus_count != ctlg.GetAllRoutes().size()) {
+        return false;
+    }
+    for (uint32_t bus_id = 0; bus_id < bus_count; ++bus_id) {
+        const Route* route = serialization::ReadString(input, name, file_size) ? ctlg.GetRoute(name) : nullptr;
+        if (!route || graph_data.bus_id_by_bus_name.count(route->name)) {
+            return false;
+        }
+        graph_data.bus_name_by_bus_id.push_back(route->name);
+        graph_data.bus_id_by_bus_name[route->name] = bus_id;
+    }
+
+    std::vector<graph::Edge<Weight>> edges;
+    EdgesRideData& rides = graph_data.edges_ride_data;
+    if (!serialization::ReadVector(input, graph_data.coordinates_by_vertex_id, file_size)
+        || graph_data.coordinates_by_vertex_id.size() < stop_count
+        || !serialization::ReadVector(input, edges, file_size)
+        || !serialization::ReadVector(input, rides.bus_ids, file_size)
+        || !serialization::ReadVector(input, rides.span_counts, file_size)
+        || !serialization::ReadVector(input, rides.start_stop_ids, file_size)
+        || !serialization::ReadVector(input, rides.finish_stop_ids, file_size)
+        || rides.bus_ids.size() != edges.size() || rides.span_counts.size() != edges.size()
+        || rides.start_stop_ids.size() != edges.size() || rides.finish_stop_ids.size() != edges.size()) {
+        return false;
+    }
+    const size_t vertex_count = graph_data.coordinates_by_vertex_id.size();
+    for (size_t edge_id = 0; edge_id < edges.size(); ++edge_id) {
+        if (edges[edge_id].from >= vertex_count || edges[edge_id].to >= vertex_count
+            || rides.bus_ids[edge_id] >= bus_count
+            || rides.start_stop_ids[edge_id] >= stop_count || rides.finish_stop_ids[edge_id] >= stop_count) {
+            return false;
+        }
+    }
+    // The file is written right after a full build, where the edges of a bus are contiguous.
+    graph_data.edges_range_by_bus_id.resize(bus_count);
+    for (size_t edge_id = 0; edge_id < edges.size(); ++edge_id) {
+        auto& [first_edge_id, last_edge_id] = graph_data.edges_range_by_bus_id[rides.bus_ids[edge_id]];
+        if (first_edge_id == last_edge_id) {
+            first_edge_id = edge_id;
+            last_edge_id = edge_id + 1;
+        } else if (last_edge_id == edge_id) {
+            ++last_edge_id;
+        } else {
+            return false;
+        }
+    }
+
+    typename graph::Router<Weight>::RoutesInternalData routes_internal_data;
+    if (routing_settings_.router_mode == RouterMode::PRECOMPUTED
+        && (!serialization::ReadVector(input, routes_internal_data.weights, file_size)
+            || !serialization::ReadVector(input, routes_internal_data.prev_edges, file_size)
+            || routes_internal_data.weights.size() != vertex_count * vertex_count
+            || routes_internal_data.prev_edges.size() != vertex_count * vertex_count)) {
+        return false;
+    }
+    if (input.peek() != std::ifstream::traits_type::eof()) {
+        return false;
+    }
+
+    graph_data.graph = graph::DirectedWeightedGraph<Weight>(vertex_count);
+    for (const auto& edge : edges) {
+        graph_data.graph.AddEdge(edge);
+    }
+    graph_data_ = std::move(graph_data);
+    if (routing_settings_.prune_parallel_edges) {
+        PruneParallelEdges();
+    }
+    if (routing_settings_.router_mode == RouterMode::PRECOMPUTED) {
+        router_ = std::make_unique<graph::Router<Weight>>(graph_data_.graph, std::move(routes_internal_data));
+        CreateGraphSearches();
     } else {
-        std::vector<EdgeInfo> items;
-        for (graph::EdgeId edge_id : route_info->edges) {
-            items.push_back(graph_data_.edge_info_by_edge_id.at(edge_id));
+        CreateRouter();
+    }
+    return true;
+}
+
+// Only the precomputed routes table is stored, the other routers are fast enough to be
+// rebuilt from the loaded graph. The file is written under a temporary name and renamed,
+// so a concurrently starting process never sees a partial file. A failed write is not
+// an error: the next start just builds everything again. Pruned edges are stored with
+// the others and pruned again on load.
+template <typename Weight>
+void BasicTransportRouter<Weight>::SaveToCacheFile(const std::string& file_path, uint64_t cache_key) const {
+    std::error_code error;
+    std::filesystem::create_directories(routing_settings_.cache_directory, error);
+    const std::string temporary_file_path = file_path + ".tmp";
+    {
+        std::ofstream output(temporary_file_path, std::ios::binary | std::ios::trunc);
+        if (!output) {
+            return;
+        }
+        output.write(CACHE_FILE_MAGIC, sizeof(CACHE_FILE_MAGIC));
+        serialization::WriteValue(output, CACHE_FORMAT_VERSION);
+        serialization::WriteValue(output, cache_key);
+        serialization::WriteValue(output, static_cast<uint64_t>(graph_data_.stop_name_by_vertex_id.size()));
+        for (const std::string_view stop_name : graph_data_.stop_name_by_vertex_id) {
+            serialization::WriteString(output, stop_name);
+        }
+        serialization::WriteValue(output, static_cast<uint64_t>(graph_data_.bus_name_by_bus_id.size()));
+        for (const std::string_view bus_name : graph_data_.bus_name_by_bus_id) {
+            serialization::WriteString(output, bus_name);
+        }
+
+        serialization::WriteVector(output, graph_data_.coordinates_by_vertex_id);
+        serialization::WriteValue(output, static_cast<uint64_t>(graph_data_.graph.GetEdgeCount()));
+        for (graph::EdgeId edge_id = 0; edge_id < graph_data_.graph.GetEdgeCount(); ++edge_id) {
+            serialization::WriteValue(output, graph_data_.graph.GetEdge(edge_id));
+        }
+        const EdgesRideData& rides = graph_data_.edges_ride_data;
+        serialization::WriteVector(output, rides.bus_ids);
+        serialization::WriteVector(output, rides.span_counts);
+        serialization::WriteVector(output, rides.start_stop_ids);
+        serialization::WriteVector(output, rides.finish_stop_ids);
+
+        if (const auto* router = dynamic_cast<const graph::Router<Weight>*>(router_.get())) {
+            serialization::WriteVector(output, router->GetRoutesInternalData().weights);
+            serialization::WriteVector(output, router->GetRoutesInternalData().prev_edges);
+        }
+        if (!output.flush()) {
+            output.close();
+            std::filesystem::remove(temporary_file_path, error);
+            return;
         }
-        return PathInfo{items, routing_settings_.bus_wait_time, route_info->weight};
     }
+    std::filesystem::rename(temporary_file_path, file_path, error);
+    if (error) {
+        std::filesystem::remove(temporary_file_path, error);
+    }
+}
+
+template <typename Weight>
+size_t BasicTransportRouter<Weight>::CountVerticesInGraph(const transport::TransportCatalogue& ctlg) const {
+    size_t vertex_count = ctlg.GetAllStops().size();
+    if (routing_settings_.graph_model == GraphModel::WAIT_RIDE) {
+        for (const auto [route_name, route_ptr] : ctlg.GetAllRoutes()) {
+            vertex_count += route_ptr->is_roundtrip ? route_ptr->stops.size() : 2 * route_ptr->stops.size();
+        }
+    }
+    return vertex_count;
+}
+
+template <typename Weight>
+std::vector<const Stop*> BasicTransportRouter<Weight>::GetStopsInVertexOrder(const transport::TransportCatalogue& ctlg) const {
+    std::vector<const Stop*> stops;
+    stops.reserve(ctlg.GetAllStops().size());
+    for (const auto [stop_name, stop_ptr] : ctlg.GetAllStops()) {
+        stops.push_back(stop_ptr);
+    }
+    if (routing_settings_.vertex_order == VertexOrder::NONE) {
+        return stops;
+    }
+    std::sort(stops.begin(), stops.end(), [](const Stop* lhs, const Stop* rhs) {
+        return lhs->name < rhs->name;
+    });
+    if (routing_settings_.vertex_order == VertexOrder::HILBERT) {
+        return OrderByHilbertCurve(std::move(stops));
+    }
+    return OrderByReverseCuthillMcKee(ctlg, std::move(stops));
 }
 
-void TransportRouter::AddVertexIdsInGraphData(const std::unordered_map<std::string_view, const Stop*>& all_stops) {
+template <typename Weight>
+void BasicTransportRouter<Weight>::AddVertexIdsInGraphData(const std::vector<const Stop*>& stops, size_t vertex_count) {
     size_t index_number_of_stop = 0;
-    for (const auto [stop_name, stop_ptr] : all_stops) {
+    graph_data_.stop_name_by_vertex_id.reserve(stops.size());
+    graph_data_.vertex_id_by_stop_id.resize(stops.size());
+    graph_data_.coordinates_by_vertex_id.resize(vertex_count);
+    for (const Stop* stop_ptr : stops) {
         graph_data_.vertex_id_by_stop_name[stop_ptr->name] = index_number_of_stop;
+        graph_data_.vertex_id_by_stop_id[stop_ptr->id] = index_number_of_stop;
+        graph_data_.stop_name_by_vertex_id.push_back(stop_ptr->name);
+        graph_data_.coordinates_by_vertex_id[index_number_of_stop] = stop_ptr->coordinates;
         ++index_number_of_stop;
     }
 }
+
+template <typename Weight>
+void BasicTransportRouter<Weight>::AddEdgeInGraph(const graph::Edge<Weight>& edge, uint32_t bus_id, uint32_t span_count,
+                                                  graph::VertexId start_stop_id, graph::VertexId finish_stop_id) {
+    graph_data_.graph.AddEdge(edge);
+    EdgesRideData& rides = graph_data_.edges_ride_data;
+    rides.bus_ids.push_back(bus_id);
+    rides.span_counts.push_back(span_count);
+    rides.start_stop_ids.push_back(static_cast<uint32_t>(start_stop_id));
+    rides.finish_stop_ids.push_back(static_cast<uint32_t>(finish_stop_id));
+}
+
+template <typename Weight>
+std::vector<graph::VertexId> BasicTransportRouter<Weight>::GetStopVertexIds(const std::vector<StopId>& stops) const {
+    std::vector<graph::VertexId> ids_stops;
+    ids_stops.reserve(stops.size());
+    for (const StopId stop_id : stops) {
+        ids_stops.push_back(graph_data_.vertex_id_by_stop_id.at(stop_id));
+    }
+    return ids_stops;
+}
+
+size_t VertexPairHasher::operator()(std::pair<graph::VertexId, graph::VertexId> vertices) const {
+    return std::hash<uint64_t>()((static_cast<uint64_t>(vertices.first) << 32) ^ static_cast<uint64_t>(vertices.second));
+}
+
+template <typename Weight>
+double BasicTransportRouter<Weight>::GetRideTime(double distance) const {
+    const int meters_in_km = 1000;
+    const int seconds_in_min = 60;
+    return (distance * seconds_in_min) / (meters_in_km * routing_settings_.bus_velocity);
+}
+
+// Fixed point weights are rounded to the nearest unit, so the error of a path is at most
+// half a unit per edge. They saturate at half the maximum of the type, so the sum of two
+// weights never overflows, which keeps a huge time limit of a bounded search safe.
+template <typename Weight>
+Weight BasicTransportRouter<Weight>::ToWeight(double minutes) {
+    if constexpr (std::is_floating_point_v<Weight>) {
+        return static_cast<Weight>(minutes);
+    } else {
+        const double max_units = static_cast<double>(std::numeric_limits<Weight>::max() / 2);
+        return static_cast<Weight>(std::llround(std::min(minutes * FIXED_POINT_UNITS_PER_MINUTE, max_units)));
+    }
+}
+
+template <typename Weight>
+double BasicTransportRouter<Weight>::ToMinutes(Weight weight) {
+    if constexpr (std::is_floating_point_v<Weight>) {
+        return static_cast<double>(weight);
+    } else {
+        return weight / FIXED_POINT_UNITS_PER_MINUTE;
+    }
+}
+
+std::unique_ptr<TransportRouterBase> MakeTransportRouter(const RoutingSettings& settings) {
+    std::unique_ptr<TransportRouterBase> router;
+    if (settings.weight_type == WeightType::FLOAT) {
+        router = std::make_unique<BasicTransportRouter<float>>();
+    } else if (settings.weight_type == WeightType::INT32) {
+        router = std::make_unique<BasicTransportRouter<int32_t>>();
+    } else {
+        router = std::make_unique<BasicTransportRouter<double>>();
+    }
+    router->SetSettings(settings);
+    return router;
+}
+
+template class BasicTransportRouter<double>;
+template class BasicTransportRouter<float>;
+template class BasicTransportRouter<int32_t>;
     
 } // namespace transport
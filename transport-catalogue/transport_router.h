@@ -1,76 +1,316 @@
 #pragma once
 
+#include "alt_router.h"
+#include "bounded_search.h"
+#include "contraction_hierarchy_router.h"
+#include "dijkstra_router.h"
+#include "lru_cache.h"
+#include "pareto_router.h"
+#include "raptor_router.h"
 #include "router.h"
+#include "thread_pool.h"
 #include "transport_catalogue.h"
 
+#include <cstdint>
 #include <memory>
+#include <optional>
+#include <string>
+#include <vector>
 
 namespace transport {
 
+enum class RouterMode {
+    PRECOMPUTED,
+    ON_DEMAND,
+    CONTRACTION_HIERARCHY,
+    LANDMARKS,
+    // Timetable routing without a graph, see RaptorRouter. Only this mode uses the
+    // departure times of the buses and the departure time of a request.
+    RAPTOR,
+};
+
+// STOP_TO_STOP connects every stop of a route with every later one, so a route of n stops
+// gives O(n^2) edges. WAIT_RIDE adds a vertex per stop of every route direction and
+// connects them with boarding, ride and alighting edges, so the edge count is linear.
+enum class GraphModel {
+    STOP_TO_STOP,
+    WAIT_RIDE,
+};
+
+// The order of the stop vertex ids. NONE keeps the order of the catalogue's hash map. HILBERT
+// orders the stops along a Hilbert curve over their coordinates, REVERSE_CUTHILL_MCKEE by
+// breadth-first search over the links between consecutive stops of the routes, so that
+// stops close on the map or in the network get close ids and close rows of the tables.
+// Both are deterministic: ties go by the stop name.
+enum class VertexOrder {
+    NONE,
+    HILBERT,
+    REVERSE_CUTHILL_MCKEE,
+};
+
+// The type of the weights of the graph and the tables, see BasicTransportRouter.
+enum class WeightType {
+    DOUBLE,
+    FLOAT,
+    INT32,
+};
+
 struct RoutingSettings {
     double bus_velocity = 0.0;
     int bus_wait_time = 0;
+    RouterMode router_mode = RouterMode::PRECOMPUTED;
+    GraphModel graph_model = GraphModel::STOP_TO_STOP;
+    size_t path_cache_capacity = 0;
+    size_t landmark_count = 16;
+    // Directory of the files with the built graph and routes table, empty to always rebuild.
+    std::string cache_directory = {};
+    // Drop every edge that has a parallel edge (same ends) not heavier than it, see PruneParallelEdges.
+    bool prune_parallel_edges = false;
+    // Report the buses of the dropped edges as alternatives of the equally fast rides of a path.
+    bool keep_edge_alternatives = false;
+    VertexOrder vertex_order = VertexOrder::NONE;
+    // The weight type of the router made by MakeTransportRouter, a BasicTransportRouter
+    // keeps its own Weight whatever the setting.
+    WeightType weight_type = WeightType::DOUBLE;
 };
 
+// A ride preceded by wait_time of waiting at start_stop. alternative_buses make the same
+// ride in the same time, they are filled only with keep_edge_alternatives.
 struct EdgeInfo {
     double weight = 0.0;
     std::string_view bus_name;
     int span_count = 0;
     std::string_view start_stop;
     std::string_view finish_stop;
+    double wait_time = 0.0;
+    std::vector<std::string_view> alternative_buses = {};
+};
+
+// Ride data of the graph edges as parallel arrays indexed by EdgeId. Boarding and alighting
+// edges of the wait/ride model are not rides and have zero span count.
+struct EdgesRideData {
+    std::vector<uint32_t> bus_ids;
+    std::vector<uint32_t> span_counts;
+    std::vector<uint32_t> start_stop_ids;
+    std::vector<uint32_t> finish_stop_ids;
+};
+
+class VertexPairHasher {
+public:
+    size_t operator()(std::pair<graph::VertexId, graph::VertexId> vertices) const;
 };
     
+// Stops take vertex ids [0, stop_name_by_vertex_id.size()), a stop id is its vertex id.
 template <typename Weight>    
 struct GraphAndItsTransportData {
     graph::DirectedWeightedGraph<Weight> graph;
     std::unordered_map<std::string_view, graph::VertexId> vertex_id_by_stop_name = {};
-    std::unordered_map<graph::EdgeId, EdgeInfo> edge_info_by_edge_id = {};
+    std::vector<graph::VertexId> vertex_id_by_stop_id = {};
+    std::vector<std::string_view> stop_name_by_vertex_id = {};
+    std::vector<geo::Coordinates> coordinates_by_vertex_id = {};
+    std::vector<std::string_view> bus_name_by_bus_id = {};
+    EdgesRideData edges_ride_data = {};
+    // Buses removed by an update keep their ids but leave bus_id_by_bus_name.
+    std::unordered_map<std::string_view, uint32_t> bus_id_by_bus_name = {};
+    // The edges of a bus are the contiguous range [first, second) of EdgeIds.
+    std::vector<std::pair<graph::EdgeId, graph::EdgeId>> edges_range_by_bus_id = {};
+    // Edges removed from the graph by the parallel edge pruning, by their (from, to) vertices.
+    std::unordered_map<std::pair<graph::VertexId, graph::VertexId>, std::vector<graph::EdgeId>, VertexPairHasher>
+        pruned_edges_by_vertices = {};
+    // Left by the updates: ride vertices without edges, taken again by the next updates,
+    // and the number of removed edges of the replaced routes.
+    std::vector<graph::VertexId> free_ride_vertices = {};
+    size_t dead_edge_count = 0;
 };
 
 struct PathInfo {
     std::vector<EdgeInfo> items;
-    int bus_wait_time = 0;
     double total_time = 0;
 };
 
-class TransportRouter {   
+struct ReachableStop {
+    std::string_view stop_name;
+    double time = 0.0;
+};
+
+// time_matrix[i][j] is the travel time from the i-th origin to the j-th destination,
+// nullopt if the destination is unreachable.
+using TimeMatrix = std::vector<std::vector<std::optional<double>>>;
+
+// The interface of BasicTransportRouter over the weight types, so that the type can be chosen
+// by a setting at run time, see MakeTransportRouter.
+class TransportRouterBase {
 public:
-    void SetSettings(RoutingSettings routing_settings);
-    void UploadTransportData(const transport::TransportCatalogue& catalogue);
-    std::optional<PathInfo> BuildPath(std::string_view stop_from, std::string_view stop_to) const;    
+    virtual void SetSettings(RoutingSettings routing_settings) = 0;
+    virtual void UploadTransportData(const transport::TransportCatalogue& catalogue) = 0;
+    // Apply a change of the catalogue made after UploadTransportData: an added, changed or
+    // removed route, or a changed road distance. Only the edges of the affected routes are
+    // replaced, the router repairs its data in place if it can.
+    virtual void UpdateRoute(const transport::TransportCatalogue& catalogue, std::string_view route_name) = 0;
+    virtual void UpdateDistance(const transport::TransportCatalogue& catalogue, std::string_view stop_from,
+                                std::string_view stop_to) = 0;
+    virtual std::optional<graph::VertexId> GetStopVertexId(std::string_view stop_name) const = 0;
+    // departure_time is in minutes from the start of the day, the total time of the path
+    // counts from it. The graph routers ignore it.
+    virtual std::optional<PathInfo> BuildPath(std::string_view stop_from, std::string_view stop_to,
+                                              double departure_time = 0.0) const = 0;
+    virtual std::optional<PathInfo> BuildPath(graph::VertexId stop_from_id, graph::VertexId stop_to_id) const = 0;
+    // Same as BuildPath, but the path is written over path_info, so a caller that keeps
+    // path_info between queries reuses its memory. Without the path cache a query on a
+    // warmed-up thread allocates nothing. Returns false if there is no path.
+    virtual bool FillPath(graph::VertexId stop_from_id, graph::VertexId stop_to_id, PathInfo& path_info) const = 0;
+    // FillPath by the stop names with the departure_time of BuildPath. A timetable path is
+    // built anew and moved into path_info.
+    virtual bool FillPath(std::string_view stop_from, std::string_view stop_to, double departure_time,
+                          PathInfo& path_info) const = 0;
+    // The Pareto set of paths by total time and number of rides, found in one search. The
+    // paths go from the fastest one to the one with the fewest rides; empty if there is no path.
+    virtual std::vector<PathInfo> BuildParetoPaths(std::string_view stop_from, std::string_view stop_to,
+                                                   double departure_time = 0.0) const = 0;
+    // The stops reachable from stop_from within max_time minutes and the travel times to
+    // them, found by one bounded search. Sorted by the time, then by the stop name.
+    virtual std::vector<ReachableStop> FindReachableStops(std::string_view stop_from, double max_time,
+                                                          double departure_time = 0.0) const = 0;
+    virtual cache::CacheStats GetPathCacheStats() const = 0;
+    virtual std::optional<TimeMatrix> BuildTimeMatrix(const std::vector<std::string_view>& stops_from,
+                                                      const std::vector<std::string_view>& stops_to,
+                                                      double departure_time = 0.0) const = 0;
+    // The number of edges dropped by the parallel edge pruning that are still out of the graph.
+    virtual size_t GetPrunedEdgeCount() const = 0;
+
+    virtual ~TransportRouterBase() = default;
+};
+
+// A BasicTransportRouter with the Weight chosen by settings.weight_type and the settings set.
+std::unique_ptr<TransportRouterBase> MakeTransportRouter(const RoutingSettings& settings);
+
+// Weight is the type of the edge weights of the graph and of the routes table. A floating
+// point weight is the time in minutes, an integer one is the time in fixed point units of
+// FIXED_POINT_UNITS_PER_MINUTE, so int32_t paths should stay within about 29 hours. The
+// total times of both differ from the double ones by millionths of a minute, which changes
+// the last printed digit of about 1% of them, see tests/weight_type_test.cpp. The times
+// given to and returned by the router are always minutes in double. The instantiations
+// for double, float and int32_t are compiled in transport_router.cpp.
+template <typename Weight>
+class BasicTransportRouter : public TransportRouterBase {
+public:
+    // Ten-thousandths of a second.
+    static constexpr double FIXED_POINT_UNITS_PER_MINUTE = 600000.0;
+
+    void SetSettings(RoutingSettings routing_settings) override;
+    void UploadTransportData(const transport::TransportCatalogue& catalogue) override;
+    void UpdateRoute(const transport::TransportCatalogue& catalogue, std::string_view route_name) override;
+    void UpdateDistance(const transport::TransportCatalogue& catalogue, std::string_view stop_from,
+                        std::string_view stop_to) override;
+    std::optional<graph::VertexId> GetStopVertexId(std::string_view stop_name) const override;
+    std::optional<PathInfo> BuildPath(std::string_view stop_from, std::string_view stop_to,
+                                      double departure_time = 0.0) const override;
+    std::optional<PathInfo> BuildPath(graph::VertexId stop_from_id, graph::VertexId stop_to_id) const override;
+    bool FillPath(graph::VertexId stop_from_id, graph::VertexId stop_to_id, PathInfo& path_info) const override;
+    bool FillPath(std::string_view stop_from, std::string_view stop_to, double departure_time,
+                  PathInfo& path_info) const override;
+    std::vector<PathInfo> BuildParetoPaths(std::string_view stop_from, std::string_view stop_to,
+                                           double departure_time = 0.0) const override;
+    std::vector<ReachableStop> FindReachableStops(std::string_view stop_from, double max_time,
+                                                  double departure_time = 0.0) const override;
+    cache::CacheStats GetPathCacheStats() const override;
+    std::optional<TimeMatrix> BuildTimeMatrix(const std::vector<std::string_view>& stops_from,
+                                              const std::vector<std::string_view>& stops_to,
+                                              double departure_time = 0.0) const override;
+    size_t GetPrunedEdgeCount() const override;
  
 private:
-    void AddVertexIdsInGraphData(const std::unordered_map<std::string_view, const Stop*>& all_stops);
+    bool ComputePath(graph::VertexId stop_from_id, graph::VertexId stop_to_id, PathInfo& path_info) const;
+    void FillPathInfo(Weight weight, const std::vector<graph::EdgeId>& edges, PathInfo& path_info) const;
+    void AddAlternativeBuses(graph::EdgeId edge_id, std::vector<std::string_view>& bus_names) const;
+    PathInfo MakePathInfo(const RaptorRouter::Journey& journey, double departure_time) const;
+    std::optional<PathInfo> ComputeTimetablePath(std::string_view stop_from, std::string_view stop_to, double departure_time) const;
+    std::optional<TimeMatrix> BuildTimetableTimeMatrix(const std::vector<std::string_view>& stops_from,
+                                                       const std::vector<std::string_view>& stops_to,
+                                                       double departure_time) const;
+    void BuildGraph(const transport::TransportCatalogue& ctlg);
+    void AddBusInGraph(const transport::TransportCatalogue& ctlg, const Route& route, uint32_t bus_id,
+                       const std::vector<graph::VertexId>& ride_vertex_ids);
+    void UpdateRoutes(const transport::TransportCatalogue& ctlg, const std::vector<std::string_view>& route_names);
+    void PruneParallelEdges();
+    void PruneParallelEdges(std::vector<graph::EdgeId>& removed_edges, std::vector<graph::EdgeId>& added_edges);
+    bool IsEdgeOfCurrentRoute(graph::EdgeId edge_id) const;
+    void CreateRouter();
+    void CreateGraphSearches();
+    uint64_t ComputeCacheKey(const transport::TransportCatalogue& ctlg) const;
+    std::string GetCacheFilePath(uint64_t cache_key) const;
+    bool LoadFromCacheFile(const std::string& file_path, uint64_t cache_key, const transport::TransportCatalogue& ctlg);
+    void SaveToCacheFile(const std::string& file_path, uint64_t cache_key) const;
+    size_t CountVerticesInGraph(const transport::TransportCatalogue& ctlg) const;
+    std::vector<const Stop*> GetStopsInVertexOrder(const transport::TransportCatalogue& ctlg) const;
+    void AddVertexIdsInGraphData(const std::vector<const Stop*>& stops, size_t vertex_count);
+    void AddEdgeInGraph(const graph::Edge<Weight>& edge, uint32_t bus_id, uint32_t span_count,
+                        graph::VertexId start_stop_id, graph::VertexId finish_stop_id);
+    std::vector<graph::VertexId> GetStopVertexIds(const std::vector<StopId>& stops) const;
+    double GetRideTime(double distance) const;
+    static Weight ToWeight(double minutes);
+    static double ToMinutes(Weight weight);
 
-    template <typename RandomIt>
-    void AddRouteInGraph(const transport::TransportCatalogue& ctlg, RandomIt vec_stops_start_it, size_t vec_stops_size, std::string_view route_name) {
-        const int meters_in_km = 1000;
-        const int seconds_in_min = 60;
+    template <typename RandomIt, typename IdsRandomIt>
+    void AddRouteInGraph(const transport::TransportCatalogue& ctlg, RandomIt vec_stops_start_it, size_t vec_stops_size,
+                         IdsRandomIt ids_stops_start_it, uint32_t bus_id) {
         for (size_t index_stop_from = 0; index_stop_from < vec_stops_size; ++index_stop_from) { 
             uint32_t total_distance = 0;
             for (size_t index_stop_to = index_stop_from + 1; index_stop_to < vec_stops_size; ++index_stop_to) {
-                auto pos_stop_from = vec_stops_start_it + index_stop_from;
                 auto pos_stop_before_to = vec_stops_start_it + index_stop_to - 1;
                 auto pos_stop_to = vec_stops_start_it + index_stop_to;
 
-                const graph::VertexId id_stop_from = graph_data_.vertex_id_by_stop_name[*pos_stop_from];
-                const graph::VertexId id_stop_to = graph_data_.vertex_id_by_stop_name[*pos_stop_to];                
+                const graph::VertexId id_stop_from = *(ids_stops_start_it + index_stop_from);
+                const graph::VertexId id_stop_to = *(ids_stops_start_it + index_stop_to);
                 total_distance += ctlg.GetDistance(*pos_stop_before_to, *pos_stop_to); 
 
-                const double weight = ((total_distance * seconds_in_min) / 
-                                      (meters_in_km * routing_settings_.bus_velocity)) + routing_settings_.bus_wait_time;
-                graph_data_.graph.AddEdge({id_stop_from, id_stop_to, weight});
-
-                const int span_count = index_stop_to - index_stop_from;
-                graph_data_.edge_info_by_edge_id[graph_data_.graph.GetEdgeCount() - 1] = 
-                {weight - routing_settings_.bus_wait_time, route_name, span_count, *pos_stop_from, *pos_stop_to};
+                const Weight weight = ToWeight(GetRideTime(total_distance) + routing_settings_.bus_wait_time);
+                const uint32_t span_count = index_stop_to - index_stop_from;
+                AddEdgeInGraph({id_stop_from, id_stop_to, weight}, bus_id, span_count, id_stop_from, id_stop_to);
             } 
         }  
     }    
 
+    // The ride vertex of the route at its i-th stop is *(ride_ids_start_it + i). Only ride edges
+    // have a span count, boarding and alighting edges separate the rides in BuildPath. Without
+    // a wait time they make zero-weight cycles through the stop, which the routers allow.
+    template <typename RandomIt, typename IdsRandomIt, typename RideIdsRandomIt>
+    void AddRouteWithRideVerticesInGraph(const transport::TransportCatalogue& ctlg, RandomIt vec_stops_start_it, size_t vec_stops_size,
+                                         IdsRandomIt ids_stops_start_it, RideIdsRandomIt ride_ids_start_it, uint32_t bus_id) {
+        for (size_t index_stop = 0; index_stop < vec_stops_size; ++index_stop) {
+            auto pos_stop = vec_stops_start_it + index_stop;
+            const graph::VertexId id_stop = *(ids_stops_start_it + index_stop);
+            const graph::VertexId id_ride = *(ride_ids_start_it + index_stop);
+            graph_data_.coordinates_by_vertex_id[id_ride] = graph_data_.coordinates_by_vertex_id[id_stop];
+            AddEdgeInGraph({id_stop, id_ride, ToWeight(routing_settings_.bus_wait_time)}, bus_id, 0, id_stop, id_stop);
+            AddEdgeInGraph({id_ride, id_stop, Weight{}}, bus_id, 0, id_stop, id_stop);
+            if (index_stop + 1 < vec_stops_size) {
+                const graph::VertexId id_stop_next = *(ids_stops_start_it + index_stop + 1);
+                const Weight weight = ToWeight(GetRideTime(ctlg.GetDistance(*pos_stop, *(pos_stop + 1))));
+                AddEdgeInGraph({id_ride, *(ride_ids_start_it + index_stop + 1), weight}, bus_id, 1, id_stop, id_stop_next);
+            }
+        }
+    }
+
     RoutingSettings routing_settings_;
-    GraphAndItsTransportData<double> graph_data_;
-    std::unique_ptr<graph::Router<double>> router_;          
+    GraphAndItsTransportData<Weight> graph_data_;
+    std::unique_ptr<graph::RouterBase<Weight>> router_;          
+    // The graph in CSR form for the searches beside router_, built again with router_
+    // and after every update of the graph. The searches refer to it.
+    graph::StaticGraph<Weight> static_graph_;
+    std::unique_ptr<graph::ParetoRouter<Weight>> pareto_router_;
+    std::unique_ptr<graph::BoundedSearch<Weight>> bounded_search_;
+    // Set instead of router_ in the RAPTOR mode, graph_data_ stays empty then.
+    std::unique_ptr<RaptorRouter> raptor_router_;
+    std::unique_ptr<concurrency::ThreadPool> thread_pool_;
+    // Finished paths, including "no path" answers. Cleared whenever the graph or the settings change.
+    mutable cache::LruCache<std::pair<graph::VertexId, graph::VertexId>, std::optional<PathInfo>, VertexPairHasher> path_cache_;
 };
+
+extern template class BasicTransportRouter<double>;
+extern template class BasicTransportRouter<float>;
+extern template class BasicTransportRouter<int32_t>;
+
+using TransportRouter = BasicTransportRouter<double>;
     
 } // namespace transport